@@ -0,0 +1,199 @@
+/**
+ * ARC implementation
+ */
+#include <algorithm>
+#include <cassert>
+
+#include "buffer/arc_replacer.h"
+#include "page/page.h"
+
+namespace cmudb {
+
+template <typename T>
+ARCReplacer<T>::ARCReplacer(size_t num_frames)
+    : capacity_(num_frames), target_(0), evictable_(0) {}
+
+template <typename T> ARCReplacer<T>::~ARCReplacer() = default;
+
+/*
+ * Record an access of the page held by value and make value evictable.
+ * A hit moves the page to T2, a miss puts it on T1 unless its id is found on
+ * a ghost list, in which case the target of T1 is adapted first.
+ */
+template <typename T> void ARCReplacer<T>::Insert(const T &value) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  key_type key = ReplacerKey<T>::Get(value);
+
+  auto entry = entries_.find(value);
+  if (entry != entries_.end() && entry->second.key != key) {
+    // frame was recycled without being victimized (e.g. page deleted)
+    Forget(entry);
+    entry = entries_.end();
+  }
+
+  if (entry != entries_.end()) {
+    Entry &e = entry->second;
+    lists_[e.list].erase(e.pos);
+    e.list = FREQUENT;
+    lists_[FREQUENT].push_front(value);
+    e.pos = lists_[FREQUENT].begin();
+    if (!e.evictable) {
+      e.evictable = true;
+      ++evictable_;
+    }
+    return;
+  }
+
+  ListId list = RECENT;
+  auto ghost = ghost_index_.find(key);
+  if (ghost != ghost_index_.end()) {
+    size_t b1 = ghosts_[RECENT].size();
+    size_t b2 = ghosts_[FREQUENT].size();
+    if (ghost->second.list == RECENT) {
+      target_ = std::min(capacity_, target_ + std::max<size_t>(b2 / b1, 1));
+    } else {
+      target_ -= std::min(target_, std::max<size_t>(b1 / b2, 1));
+    }
+    ghosts_[ghost->second.list].erase(ghost->second.pos);
+    ghost_index_.erase(ghost);
+    list = FREQUENT;
+  }
+
+  lists_[list].push_front(value);
+  entries_.emplace(value, Entry{key, list, true, lists_[list].begin()});
+  ++evictable_;
+  TrimGhosts();
+}
+
+/*
+ * Evict from T1 when it is above its target, from T2 otherwise. Fall back to
+ * the other list when every page on the chosen one is pinned.
+ */
+template <typename T> bool ARCReplacer<T>::Victim(T &value) {
+  return Victim(value, VictimFilter<T>());
+}
+
+/*
+ * Same choice of list, only values accepted by filter are evicted
+ */
+template <typename T>
+bool ARCReplacer<T>::Victim(T &value, const VictimFilter<T> &filter) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (evictable_ == 0) {
+    return false;
+  }
+  ListId list = (lists_[RECENT].size() > target_ || lists_[FREQUENT].empty())
+                    ? RECENT
+                    : FREQUENT;
+  if (EvictFrom(list, value, filter)) {
+    return true;
+  }
+  bool evicted = EvictFrom(list == RECENT ? FREQUENT : RECENT, value, filter);
+  assert(evicted || filter);
+  return evicted;
+}
+
+/*
+ * Make value not evictable, it keeps its place on T1/T2. return true if value
+ * was evictable
+ */
+template <typename T> bool ARCReplacer<T>::Erase(const T &value) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto entry = entries_.find(value);
+  if (entry == entries_.end() || !entry->second.evictable) {
+    return false;
+  }
+  entry->second.evictable = false;
+  --evictable_;
+  return true;
+}
+
+template <typename T> size_t ARCReplacer<T>::Size() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return evictable_;
+}
+
+template <typename T> size_t ARCReplacer<T>::GetAdaptiveTarget() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return target_;
+}
+
+template <typename T> size_t ARCReplacer<T>::GetGhostSize() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return ghost_index_.size();
+}
+
+/*
+ * helper function to evict the least recently used evictable value of list
+ * accepted by filter and remember its page id on the matching ghost list
+ * should be called when holding the lock
+ */
+template <typename T>
+bool ARCReplacer<T>::EvictFrom(ListId list, T &value,
+                               const VictimFilter<T> &filter) {
+  for (auto it = lists_[list].rbegin(); it != lists_[list].rend(); ++it) {
+    auto entry = entries_.find(*it);
+    assert(entry != entries_.end());
+    if (!entry->second.evictable || (filter && !filter(*it))) {
+      continue;
+    }
+    value = *it;
+    key_type key = entry->second.key;
+    lists_[list].erase(entry->second.pos);
+    entries_.erase(entry);
+    --evictable_;
+
+    ghosts_[list].push_front(key);
+    ghost_index_[key] = Ghost{list, ghosts_[list].begin()};
+    TrimGhosts();
+    return true;
+  }
+  return false;
+}
+
+/*
+ * helper function to drop an entry without leaving a ghost behind
+ * should be called when holding the lock
+ */
+template <typename T>
+void ARCReplacer<T>::Forget(
+    typename std::unordered_map<T, Entry>::iterator entry) {
+  lists_[entry->second.list].erase(entry->second.pos);
+  if (entry->second.evictable) {
+    --evictable_;
+  }
+  entries_.erase(entry);
+}
+
+/*
+ * Adapt c to the new number of frames, the ghost lists shrink along
+ */
+template <typename T> void ARCReplacer<T>::SetNumFrames(size_t num_frames) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  capacity_ = num_frames;
+  target_ = std::min(target_, capacity_);
+  TrimGhosts();
+}
+
+/*
+ * helper function to keep |T1| + |B1| <= c and |T1| + |T2| + |B1| + |B2| <= 2c
+ * should be called when holding the lock
+ */
+template <typename T> void ARCReplacer<T>::TrimGhosts() {
+  while (!ghosts_[RECENT].empty() &&
+         lists_[RECENT].size() + ghosts_[RECENT].size() > capacity_) {
+    ghost_index_.erase(ghosts_[RECENT].back());
+    ghosts_[RECENT].pop_back();
+  }
+  while (!ghosts_[FREQUENT].empty() &&
+         entries_.size() + ghost_index_.size() > 2 * capacity_) {
+    ghost_index_.erase(ghosts_[FREQUENT].back());
+    ghosts_[FREQUENT].pop_back();
+  }
+}
+
+template class ARCReplacer<Page *>;
+// test only
+template class ARCReplacer<int>;
+
+} // namespace cmudb
@@ -0,0 +1,31 @@
+/**
+ * buffer_access_strategy.cpp
+ */
+
+#include <algorithm>
+
+#include "buffer/buffer_access_strategy.h"
+#include "buffer/buffer_pool_manager.h"
+
+namespace cmudb {
+
+/*
+ * Every shard gets an equal part of ring_size, at least one frame
+ */
+BufferAccessStrategy::BufferAccessStrategy(
+    BufferPoolManager *buffer_pool_manager, size_t num_instances,
+    size_t ring_size)
+    : buffer_pool_manager_(buffer_pool_manager), ring_size_(0) {
+  for (size_t i = 0; i < num_instances; ++i) {
+    size_t capacity = std::max<size_t>(
+        1, ring_size / num_instances + (i < ring_size % num_instances ? 1 : 0));
+    rings_.emplace_back(capacity);
+    ring_size_ += capacity;
+  }
+}
+
+BufferAccessStrategy::~BufferAccessStrategy() {
+  buffer_pool_manager_->ReleaseStrategy(this);
+}
+
+} // namespace cmudb
@@ -6,218 +6,534 @@
  * it, also to unpin a page in the buffer pool.
  */
 
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
 #include "buffer/buffer_pool_manager.h"
+#include "common/exception.h"
+#include "common/logger.h"
 
 namespace cmudb {
 
 /*
  * BufferPoolManager Constructor
  * When log_manager is nullptr, logging is disabled (for test purpose)
- * WARNING: Do Not Edit This Function
+ * pool_size frames are spread as evenly as possible over num_instances
+ * shards, every shard gets at least one frame and its own replacer built
+ * with the given policy and an equal share of compressed_cache_size bytes
+ * of compressed cache (none if 0)
+ * A read_only pool refuses NewPage and DeletePage and, if the disk manager
+ * can map the file, serves misses from the mapping. The file is not mapped
+ * while a writing pool uses the disk manager, the pool then copies pages
+ * into its frames like any other. A writing pool can not be created while a
+ * read-only pool maps the file, the constructor throws
  */
 BufferPoolManager::BufferPoolManager(size_t pool_size,
                                      DiskManager *disk_manager,
-                                     LogManager *log_manager)
+                                     LogManager *log_manager,
+                                     size_t num_instances,
+                                     ReplacerPolicy policy,
+                                     size_t compressed_cache_size,
+                                     bool read_only)
     : pool_size_(pool_size), disk_manager_(disk_manager),
-      log_manager_(log_manager) {
+      read_only_(read_only),
+      mapped_reads_(read_only && disk_manager->MapFile()), active_scans_(0),
+      cleaner_target_(pool_size / 4),
+      cleaner_batch_size_(PAGE_CLEANER_BATCH_SIZE),
+      cleaner_interval_(PAGE_CLEANER_INTERVAL), cleaner_running_(false),
+      dump_interval_(PAGE_DUMP_INTERVAL), dumper_running_(false),
+      prefetch_running_(false) {
+  assert(pool_size > 0);
+  if (!read_only_ && !disk_manager_->AddWriter()) {
+    throw Exception(EXCEPTION_TYPE_INVALID,
+                    "BufferPoolManager: db file is mapped by a read-only pool");
+  }
+  num_instances = std::max<size_t>(1, std::min(num_instances, pool_size));
 
-  // a consecutive memory space for buffer pool
-  pages_ = new Page[pool_size_];
-  free_list_ = new std::list<Page *>;
+  for (size_t i = 0; i < num_instances; ++i) {
+    size_t instance_size =
+        pool_size / num_instances + (i < pool_size % num_instances ? 1 : 0);
+    instances_.emplace_back(new BufferPoolManagerInstance(
+        instance_size, disk_manager_, log_manager, policy,
+        compressed_cache_size / num_instances, mapped_reads_));
+  }
+}
 
-  replacer_ = new LRUReplacer<Page *>;
-  page_table_ = new ExtendibleHash<page_id_t, Page *>(BUCKET_SIZE);
+BufferPoolManager::~BufferPoolManager() {
+  StopPageCleaner();
+  StopPageDumper();
+  {
+    std::lock_guard<std::mutex> lock(prefetch_latch_);
+    prefetch_running_ = false;
+  }
+  prefetch_cv_.notify_all();
+  if (prefetch_thread_.joinable()) {
+    prefetch_thread_.join();
+  }
+  // the last reference to a strategy may be queued, release it while the
+  // shards are still there
+  prefetch_queue_.clear();
+  // nothing is read or written through the pool anymore
+  if (mapped_reads_) {
+    disk_manager_->UnmapFile();
+  } else if (!read_only_) {
+    disk_manager_->RemoveWriter();
+  }
+}
 
-  // put all the pages into free list
-  for (size_t i = 0; i < pool_size_; ++i) {
-    free_list_->push_back(&pages_[i]);
+Page *BufferPoolManager::FetchPage(page_id_t page_id,
+                                   BufferAccessStrategy *strategy) {
+  assert(page_id != INVALID_PAGE_ID);
+  return GetInstance(page_id)->FetchPage(page_id, GetRing(strategy, page_id));
+}
+
+bool BufferPoolManager::UnpinPage(page_id_t page_id, bool is_dirty) {
+  assert(page_id != INVALID_PAGE_ID);
+  return GetInstance(page_id)->UnpinPage(page_id, is_dirty);
+}
+
+bool BufferPoolManager::FlushPage(page_id_t page_id) {
+  assert(page_id != INVALID_PAGE_ID);
+  return GetInstance(page_id)->FlushPage(page_id);
+}
+
+bool BufferPoolManager::DeletePage(page_id_t page_id) {
+  assert(page_id != INVALID_PAGE_ID);
+  if (read_only_) {
+    return false;
   }
+  return GetInstance(page_id)->DeletePage(page_id);
 }
 
-/*
- * BufferPoolManager Destructor
- * WARNING: Do Not Edit This Function
+/**
+ * User should call this method if needs to create a new page. This routine
+ * will call disk manager to allocate a page, then hand it to the shard the
+ * new page id hashes to. return nullptr if all the pages in that shard are
+ * pinned, in which case the page id is given back to the disk manager.
+ * A read only pool returns nullptr
  */
-BufferPoolManager::~BufferPoolManager() {
-  delete[] pages_;
-  delete page_table_;
-  delete replacer_;
-  delete free_list_;
+Page *BufferPoolManager::NewPage(page_id_t &page_id, page_id_t near) {
+  if (read_only_) {
+    page_id = INVALID_PAGE_ID;
+    return nullptr;
+  }
+  page_id = disk_manager_->AllocatePage(near);
+  Page *res = GetInstance(page_id)->NewPage(page_id);
+  if (res == nullptr) {
+    disk_manager_->DeallocatePage(page_id);
+    page_id = INVALID_PAGE_ID;
+  }
+  return res;
 }
 
-/**
- * 1. search hash table.
- *  1.1 if exist, pin the page and return immediately
- *  1.2 if no exist, find a replacement entry from either free list or lru
- *      replacer. (NOTE: always find from free list first)
- * 2. If the entry chosen for replacement is dirty, write it back to disk.
- * 3. Delete the entry for the old page from the hash table and insert an
- * entry for the new page.
- * 4. Update page metadata, read page content from disk file and return page
- * pointer
+PageGuard BufferPoolManager::FetchPageGuarded(page_id_t page_id) {
+  return PageGuard(this, FetchPage(page_id));
+}
+
+ReadPageGuard BufferPoolManager::FetchPageRead(page_id_t page_id,
+                                               BufferAccessStrategy *strategy) {
+  Page *page = FetchPage(page_id, strategy);
+  if (page != nullptr) {
+    page->RLatch();
+  }
+  return ReadPageGuard(this, page);
+}
+
+WritePageGuard BufferPoolManager::FetchPageWrite(page_id_t page_id) {
+  Page *page = FetchPage(page_id);
+  if (page != nullptr) {
+    page->WLatch();
+  }
+  return WritePageGuard(this, page);
+}
+
+PageGuard BufferPoolManager::NewPageGuarded(page_id_t &page_id,
+                                            page_id_t near) {
+  return PageGuard(this, NewPage(page_id, near));
+}
+
+/*
+ * Flush the whole pool, e.g. for a checkpoint. Every shard hands over copies
+ * of its dirty pages, which are then sorted by page id so that a run of
+ * consecutive pages becomes one write, whichever shards they came from. The
+ * writes are made durable by a single sync at the end
  */
-Page *BufferPoolManager::FetchPage(page_id_t page_id) {
-  assert(page_id != INVALID_PAGE_ID);
-  std::lock_guard<std::mutex> lock(latch_);
-
-  Page *res = nullptr;
-  if (page_table_->Find(page_id, res)) {
-    // mark the Page as pinned
-    ++res->pin_count_;
-    // remove its entry from LRUReplacer
-    replacer_->Erase(res);
-    return res;
-  } else {
-    if (!free_list_->empty()) {
-      res = free_list_->front();
-      free_list_->pop_front();
-    } else {
-      if (!replacer_->Victim(res)) {
-        return nullptr;
-      }
+size_t BufferPoolManager::FlushAllPages() {
+  std::lock_guard<std::mutex> lock(flush_latch_);
+
+  std::vector<std::vector<page_id_t>> page_ids(instances_.size());
+  std::vector<std::vector<char>> buffers(instances_.size());
+  for (size_t i = 0; i < instances_.size(); ++i) {
+    instances_[i]->BeginFlush(page_ids[i], buffers[i]);
+  }
+
+  size_t page_size = disk_manager_->GetPageSize();
+  std::vector<std::pair<page_id_t, const char *>> pages;
+  for (size_t i = 0; i < instances_.size(); ++i) {
+    for (size_t j = 0; j < page_ids[i].size(); ++j) {
+      pages.emplace_back(page_ids[i][j], &buffers[i][j * page_size]);
     }
   }
+  std::sort(pages.begin(), pages.end());
 
-  assert(res->pin_count_ == 0);
-  // dirty? write back
-  if (res->is_dirty_) {
-    if (ENABLE_LOGGING) {
-      while (res->GetLSN() > log_manager_->GetPersistentLSN()) {
-        std::promise<void> promise;
-      }
+  std::vector<const char *> run;
+  for (size_t i = 0; i < pages.size(); ++i) {
+    run.push_back(pages[i].second);
+    if (i + 1 == pages.size() || pages[i + 1].first != pages[i].first + 1) {
+      disk_manager_->WritePages(pages[i].first - (run.size() - 1), run.data(),
+                                run.size());
+      run.clear();
     }
-    disk_manager_->WritePage(res->page_id_, res->GetData());
   }
-  // delete the entry for old page.
-  page_table_->Remove(res->page_id_);
+  disk_manager_->Sync();
 
-  // insert an entry for the new page.
-  page_table_->Insert(page_id, res);
+  for (size_t i = 0; i < instances_.size(); ++i) {
+    instances_[i]->EndFlush(page_ids[i]);
+  }
+  return pages.size();
+}
 
-  // initial meta data
-  res->page_id_ = page_id;
-  res->is_dirty_ = false;
-  res->pin_count_ = 1;
-  disk_manager_->ReadPage(page_id, res->GetData());
+/*
+ * Spread pool_size over the shards the way the constructor does, every shard
+ * keeps at least one frame. Each shard resizes under its own latch, so the
+ * other shards keep serving requests meanwhile
+ */
+size_t BufferPoolManager::Resize(size_t pool_size) {
+  std::lock_guard<std::mutex> lock(resize_latch_);
+  size_t num_instances = instances_.size();
+  pool_size = std::max(pool_size, num_instances);
 
-  return res;
+  size_t total = 0;
+  for (size_t i = 0; i < num_instances; ++i) {
+    size_t instance_size =
+        pool_size / num_instances + (i < pool_size % num_instances ? 1 : 0);
+    total += instances_[i]->Resize(instance_size);
+  }
+  pool_size_ = total;
+  return total;
 }
 
 /*
- * Implementation of unpin page
- * if pin_count>0, decrement it and if it becomes zero, put it back to
- * replacer if pin_count<=0 before this call, return false. is_dirty: set the
- * dirty flag of this page
+ * The ring is capped to an eighth of the pool, but the cap leaves room for
+ * the page the scan is on plus a full read-ahead window. A ring of one frame
+ * would never be recycled, the scan keeps it pinned. A pool where the ring
+ * would take more than a quarter of the frames, the cap of a read-ahead
+ * window, is too small for a ring and gets no strategy
  */
-bool BufferPoolManager::UnpinPage(page_id_t page_id, bool is_dirty) {
-  assert(page_id != INVALID_PAGE_ID);
-  std::lock_guard<std::mutex> lock(latch_);
+std::shared_ptr<BufferAccessStrategy>
+BufferPoolManager::GetAccessStrategy(size_t ring_size) {
+  ring_size = std::min(
+      ring_size, std::max<size_t>(READ_AHEAD_PAGES + 1, pool_size_ / 8));
+  if (ring_size < 2 || ring_size > pool_size_ / 4) {
+    return nullptr;
+  }
+  // the kernel reads ahead aggressively and drops pages behind a scan
+  if (mapped_reads_ && active_scans_++ == 0) {
+    disk_manager_->AdviseMapping(MapAdvice::SEQUENTIAL);
+  }
+  return std::make_shared<BufferAccessStrategy>(this, instances_.size(),
+                                                ring_size);
+}
+
+void BufferPoolManager::ReleaseStrategy(BufferAccessStrategy *strategy) {
+  for (size_t i = 0; i < instances_.size(); ++i) {
+    instances_[i]->ReleaseRing(strategy->GetRing(i));
+  }
+  if (mapped_reads_ && --active_scans_ == 0) {
+    disk_manager_->AdviseMapping(MapAdvice::NORMAL);
+  }
+}
+
+/*
+ * Queue pages for the read-ahead thread and return immediately. Pages that
+ * are not allocated are skipped (past the end here, freed ones when they are
+ * read), the window is capped to a quarter of the pool (the ring of strategy
+ * less the frame the scan is on) so that read-ahead does not evict the pages
+ * it brought in itself, and requests are dropped while the thread is already
+ * a pool size behind. With mapped reads the kernel reads the pages into its
+ * page cache instead, a later miss finds them in the mapping
+ */
+void BufferPoolManager::Prefetch(
+    page_id_t page_id, size_t count,
+    std::shared_ptr<BufferAccessStrategy> strategy) {
+  if (page_id == INVALID_PAGE_ID) {
+    return;
+  }
+  count = std::min(count, std::max<size_t>(1, pool_size_ / 4));
+  if (strategy != nullptr) {
+    count = std::min(count, strategy->GetRingSize() - 1);
+  }
+  page_id_t end = std::min<page_id_t>(page_id + count,
+                                      disk_manager_->GetNextPageId());
+  if (mapped_reads_) {
+    if (page_id < end) {
+      disk_manager_->AdviseMapping(MapAdvice::WILLNEED, page_id,
+                                   end - page_id);
+    }
+    return;
+  }
 
-  Page *page;
-  if (page_table_->Find(page_id, page)) {
-    if (page->pin_count_ <= 0) {
-      return false;
+  std::lock_guard<std::mutex> lock(prefetch_latch_);
+  StartPrefetcher();
+  for (; page_id < end && prefetch_queue_.size() < pool_size_; ++page_id) {
+    prefetch_queue_.push_back(PrefetchRequest{page_id, strategy, false});
+  }
+  prefetch_cv_.notify_one();
+}
+
+void BufferPoolManager::StartPrefetcher() {
+  if (!prefetch_thread_.joinable()) {
+    prefetch_running_ = true;
+    prefetch_thread_ = std::thread(&BufferPoolManager::Prefetcher, this);
+  }
+}
+
+void BufferPoolManager::Prefetcher() {
+  std::unique_lock<std::mutex> lock(prefetch_latch_);
+  while (true) {
+    prefetch_cv_.wait(lock, [this] {
+      return !prefetch_running_ || !prefetch_queue_.empty();
+    });
+    if (!prefetch_running_) {
+      return;
     }
-    if (--page->pin_count_ == 0) {
-      replacer_->Insert(page);
+    // a batch keeps all its frames pinned until its reads are done, it may
+    // take at most a quarter of the pool like a read-ahead window
+    size_t max_batch = std::max<size_t>(
+        1, std::min<size_t>(READ_AHEAD_BATCH_PAGES, pool_size_ / 4));
+    std::vector<PrefetchRequest> batch;
+    do {
+      batch.push_back(std::move(prefetch_queue_.front()));
+      prefetch_queue_.pop_front();
+    } while (!prefetch_queue_.empty() && batch.size() < max_batch &&
+             prefetch_queue_.front().page_id == batch.back().page_id + 1);
+    lock.unlock();
+    ReadAhead(batch);
+    // may be the last references, the strategies give their rings back
+    batch.clear();
+    lock.lock();
+  }
+}
+
+/*
+ * The pages of batch are adjacent. Every page gets its frame from its shard
+ * first, the frames stay pinned and io in progress while the runs of
+ * adjacent pages that need a disk read are read with one vectored read each
+ */
+void BufferPoolManager::ReadAhead(const std::vector<PrefetchRequest> &batch) {
+  std::vector<Page *> frames(batch.size());
+  for (size_t i = 0; i < batch.size(); ++i) {
+    page_id_t page_id = batch[i].page_id;
+    GetInstance(page_id)->BeginPrefetch(
+        page_id, GetRing(batch[i].strategy.get(), page_id), batch[i].warm_up,
+        frames[i]);
+  }
+
+  std::vector<char *> run;
+  for (size_t i = 0; i < batch.size(); ++i) {
+    if (frames[i] == nullptr) {
+      continue;
     }
-    if (is_dirty) {
-      page->is_dirty_ = true;
+    run.push_back(frames[i]->GetData());
+    if (i + 1 == batch.size() || frames[i + 1] == nullptr) {
+      disk_manager_->ReadPages(batch[i].page_id - (run.size() - 1),
+                               run.data(), run.size());
+      run.clear();
+    }
+  }
+
+  for (size_t i = 0; i < batch.size(); ++i) {
+    if (frames[i] != nullptr) {
+      GetInstance(batch[i].page_id)->EndPrefetch(frames[i]);
     }
-    return true;
   }
-  return false;
 }
 
+// warm-up file layout: magic (8) | version (4) | count (4) | page ids
+static const char WARMUP_MAGIC[8] = {'C', 'M', 'U', 'D', 'B', 'W', 'U', '1'};
+static const uint32_t WARMUP_VERSION = 1;
+
 /*
- * Used to flush a particular page of the buffer pool to disk. Should call the
- * write_page method of the disk manager
- * if page is not found in page table, return false
- * NOTE: make sure page_id != INVALID_PAGE_ID
+ * The shards' lists are interleaved by rank so the file stays ordered by
+ * recency across shards. The file is written aside and renamed over the old
+ * one, a crash while dumping leaves the previous dump in place
  */
-bool BufferPoolManager::FlushPage(page_id_t page_id) {
-  assert(page_id != INVALID_PAGE_ID);
-  std::lock_guard<std::mutex> lock(latch_);
+size_t BufferPoolManager::DumpPages(const std::string &file_name) {
+  std::vector<std::vector<page_id_t>> resident(instances_.size());
+  size_t longest = 0;
+  for (size_t i = 0; i < instances_.size(); ++i) {
+    instances_[i]->GetResidentPages(resident[i]);
+    longest = std::max(longest, resident[i].size());
+  }
+  std::vector<page_id_t> page_ids;
+  for (size_t rank = 0; rank < longest; ++rank) {
+    for (auto &ids : resident) {
+      if (rank < ids.size()) {
+        page_ids.push_back(ids[rank]);
+      }
+    }
+  }
 
-  Page *page;
-  if (page_table_->Find(page_id, page)) {
-    disk_manager_->WritePage(page_id, page->GetData());
-    return true;
+  std::string tmp_name = file_name + ".tmp";
+  std::ofstream out(tmp_name, std::ios::binary | std::ios::trunc);
+  uint32_t version = WARMUP_VERSION;
+  uint32_t count = static_cast<uint32_t>(page_ids.size());
+  out.write(WARMUP_MAGIC, sizeof(WARMUP_MAGIC));
+  out.write(reinterpret_cast<const char *>(&version), 4);
+  out.write(reinterpret_cast<const char *>(&count), 4);
+  out.write(reinterpret_cast<const char *>(page_ids.data()),
+            page_ids.size() * sizeof(page_id_t));
+  out.close();
+  if (out.fail() || std::rename(tmp_name.c_str(), file_name.c_str()) != 0) {
+    LOG_DEBUG("I/O error while writing warm-up file");
+    std::remove(tmp_name.c_str());
+    return 0;
   }
-  return false;
+  return page_ids.size();
 }
 
-/**
- * User should call this method for deleting a page. This routine will call
- * disk manager to deallocate the page. First, if page is found within page
- * table, buffer pool manager should be responsible for removing this entry out
- * of page table, resetting page metadata and adding back to free list. Second,
- * call disk manager's DeallocatePage() method to delete from disk file. If
- * the page is found within page table, but pin_count != 0, return false
+/*
+ * A missing, stale or corrupted file is not an error, the pool just starts
+ * cold. Pages that no longer exist are skipped, the hottest pool size of
+ * the rest are queued in page id order so the reads sweep the file once
  */
-bool BufferPoolManager::DeletePage(page_id_t page_id) {
-  assert(page_id != INVALID_PAGE_ID);
-  std::lock_guard<std::mutex> lock(latch_);
+size_t BufferPoolManager::LoadPages(const std::string &file_name) {
+  std::ifstream in(file_name, std::ios::binary);
+  char magic[sizeof(WARMUP_MAGIC)];
+  uint32_t version = 0, count = 0;
+  in.read(magic, sizeof(magic));
+  in.read(reinterpret_cast<char *>(&version), 4);
+  in.read(reinterpret_cast<char *>(&count), 4);
+  if (!in || memcmp(magic, WARMUP_MAGIC, sizeof(WARMUP_MAGIC)) != 0 ||
+      version != WARMUP_VERSION) {
+    return 0;
+  }
 
-  Page *page;
-  if (page_table_->Find(page_id, page) && page->pin_count_ == 0) {
-    page_table_->Remove(page_id);
-    replacer_->Erase(page);
-    disk_manager_->DeallocatePage(page_id);
+  std::vector<page_id_t> page_ids;
+  for (uint32_t i = 0; i < count && page_ids.size() < pool_size_; ++i) {
+    page_id_t page_id;
+    if (!in.read(reinterpret_cast<char *>(&page_id), sizeof(page_id))) {
+      return 0;
+    }
+    if (disk_manager_->IsAllocated(page_id)) {
+      page_ids.push_back(page_id);
+    }
+  }
+  std::sort(page_ids.begin(), page_ids.end());
 
-    page->page_id_ = INVALID_PAGE_ID;
-    page->is_dirty_ = false;
-    free_list_->push_back(page);
+  std::lock_guard<std::mutex> lock(prefetch_latch_);
+  StartPrefetcher();
+  for (page_id_t page_id : page_ids) {
+    prefetch_queue_.push_back(PrefetchRequest{page_id, nullptr, true});
   }
-  return false;
+  prefetch_cv_.notify_one();
+  return page_ids.size();
 }
 
-/**
- * User should call this method if needs to create a new page. This routine
- * will call disk manager to allocate a page.
- * Buffer pool manager should be responsible to choose a victim page either
- * from free list or lru replacer(NOTE: always choose from free list first),
- * update new page's metadata, zero out memory and add corresponding entry
- * into page table. return nullptr if all the pages in pool are pinned
+/*
+ * Start a separate thread that dumps the resident pages to file_name every
+ * interval, see DumpPages
  */
-Page *BufferPoolManager::NewPage(page_id_t &page_id) {
-  std::lock_guard<std::mutex> lock(latch_);
-
-  Page *res = nullptr;
-  if (!free_list_->empty()) {
-    res = free_list_->front();
-    free_list_->pop_front();
-  } else {
-    if (!replacer_->Victim(res)) {
-      return nullptr;
-    }
+void BufferPoolManager::RunPageDumper(const std::string &file_name,
+                                      std::chrono::milliseconds interval) {
+  std::lock_guard<std::mutex> lock(dumper_latch_);
+  if (dumper_running_) {
+    return;
   }
+  dump_file_name_ = file_name;
+  dump_interval_ = interval;
+  dumper_running_ = true;
+  dumper_thread_ = std::thread(&BufferPoolManager::PageDumper, this);
+}
 
-  assert(res->pin_count_ == 0);
-  page_id = disk_manager_->AllocatePage();
+/*
+ * Stop and join the page dumper thread
+ */
+void BufferPoolManager::StopPageDumper() {
+  {
+    std::lock_guard<std::mutex> lock(dumper_latch_);
+    dumper_running_ = false;
+  }
+  dumper_cv_.notify_all();
+  if (dumper_thread_.joinable()) {
+    dumper_thread_.join();
+  }
+}
 
-  // dirty? write back
-  if (res->is_dirty_) {
-    if (ENABLE_LOGGING) {
-      while (res->GetLSN() > log_manager_->GetPersistentLSN()) {
-        std::promise<void> promise;
-      }
+void BufferPoolManager::PageDumper() {
+  std::unique_lock<std::mutex> lock(dumper_latch_);
+  while (true) {
+    dumper_cv_.wait_for(lock, dump_interval_,
+                        [this] { return !dumper_running_; });
+    if (!dumper_running_) {
+      return;
     }
-    disk_manager_->WritePage(res->page_id_, res->GetData());
+    lock.unlock();
+    DumpPages(dump_file_name_);
+    lock.lock();
   }
-  // delete the entry for old page.
-  page_table_->Remove(res->page_id_);
+}
 
-  // insert an entry for the new page.
-  page_table_->Insert(page_id, res);
+/*
+ * Start a separate thread that writes back dirty pages periodically, see
+ * BufferPoolManagerInstance::CleanPages
+ */
+void BufferPoolManager::RunPageCleaner() {
+  std::lock_guard<std::mutex> lock(cleaner_latch_);
+  if (cleaner_running_) {
+    return;
+  }
+  cleaner_running_ = true;
+  cleaner_thread_ = std::thread(&BufferPoolManager::PageCleaner, this);
+}
 
-  // initial meta data
-  res->page_id_ = page_id;
-  res->is_dirty_ = false;
-  res->pin_count_ = 1;
-  res->ResetMemory();
+/*
+ * Stop and join the page cleaner thread
+ */
+void BufferPoolManager::StopPageCleaner() {
+  {
+    std::lock_guard<std::mutex> lock(cleaner_latch_);
+    cleaner_running_ = false;
+  }
+  cleaner_cv_.notify_all();
+  if (cleaner_thread_.joinable()) {
+    cleaner_thread_.join();
+  }
+}
 
-  return res;
+void BufferPoolManager::SetCleanerInterval(
+    std::chrono::milliseconds interval) {
+  std::lock_guard<std::mutex> lock(cleaner_latch_);
+  cleaner_interval_ = interval;
+}
+
+/*
+ * Every round asks each shard for its share of the clean frame target. The
+ * next round starts right away as long as some shard had to stop at the
+ * batch size, otherwise the cleaner sleeps for the wake interval
+ */
+void BufferPoolManager::PageCleaner() {
+  std::unique_lock<std::mutex> lock(cleaner_latch_);
+  while (cleaner_running_) {
+    lock.unlock();
+    size_t batch_size = cleaner_batch_size_;
+    size_t target =
+        (cleaner_target_ + instances_.size() - 1) / instances_.size();
+    bool behind = false;
+    for (auto &instance : instances_) {
+      if (instance->CleanPages(batch_size, target) == batch_size &&
+          batch_size > 0) {
+        behind = true;
+      }
+    }
+    lock.lock();
+    if (!behind) {
+      cleaner_cv_.wait_for(lock, cleaner_interval_,
+                           [this] { return !cleaner_running_; });
+    }
+  }
 }
 
 } // namespace cmudb
@@ -0,0 +1,777 @@
+/*
+ * buffer_pool_manager_instance.cpp
+ *
+ * Functionality: One shard of the buffer pool, see
+ * buffer_pool_manager_instance.h
+ */
+
+#include <algorithm>
+#include <chrono>
+
+#include "buffer/buffer_pool_manager_instance.h"
+
+namespace cmudb {
+
+/*
+ * BufferPoolManagerInstance Constructor
+ * When log_manager is nullptr, logging is disabled (for test purpose)
+ * With mapped_reads the file mapping of disk_manager takes the place of the
+ * compressed cache, evicted pages stay in the OS page cache anyway
+ */
+BufferPoolManagerInstance::BufferPoolManagerInstance(
+    size_t pool_size, DiskManager *disk_manager, LogManager *log_manager,
+    ReplacerPolicy policy, size_t compressed_cache_size, bool mapped_reads)
+    : pool_size_(pool_size), page_size_(disk_manager->GetPageSize()),
+      disk_manager_(disk_manager), log_manager_(log_manager),
+      compressed_cache_(nullptr), mapped_reads_(mapped_reads),
+      access_clock_(0) {
+
+  // a consecutive memory space for buffer pool, with room to grow
+  arena_ = new FrameArena(pool_size_, page_size_, BUFFER_POOL_HUGE_PAGES,
+                          pool_size_ * BUFFER_POOL_MAX_GROWTH);
+  pages_ = arena_->GetFrames();
+  free_list_ = new std::list<Page *>;
+
+  switch (policy) {
+  case ReplacerPolicy::CLOCK:
+    replacer_ = new ClockReplacer<Page *>(arena_->GetMaxFrames(), pages_);
+    break;
+  case ReplacerPolicy::LRU_K:
+    replacer_ = new LRUKReplacer<Page *>(LRUK_REPLACER_K);
+    break;
+  case ReplacerPolicy::ARC:
+    replacer_ = new ARCReplacer<Page *>(pool_size_);
+    break;
+  case ReplacerPolicy::LRU:
+  default:
+    replacer_ = new LRUReplacer<Page *>;
+    break;
+  }
+  page_table_ = new LinearProbeHashTable<page_id_t, Page *>(pool_size_);
+  if (compressed_cache_size > 0 && !mapped_reads_) {
+    compressed_cache_ = new CompressedCache(compressed_cache_size, page_size_);
+  }
+
+  // put all the pages into free list
+  for (size_t i = 0; i < pool_size_; ++i) {
+    free_list_->push_back(&pages_[i]);
+  }
+}
+
+/*
+ * BufferPoolManagerInstance Destructor
+ */
+BufferPoolManagerInstance::~BufferPoolManagerInstance() {
+  delete arena_;
+  delete page_table_;
+  delete replacer_;
+  delete free_list_;
+  delete compressed_cache_;
+}
+
+/*
+ * helper function to take the latch. Only a contended acquisition is timed,
+ * the uncontended path costs a single try_lock
+ */
+std::unique_lock<std::mutex> BufferPoolManagerInstance::AcquireLatch() {
+  std::unique_lock<std::mutex> lock(latch_, std::try_to_lock);
+  if (!lock.owns_lock()) {
+    auto start = std::chrono::steady_clock::now();
+    lock.lock();
+    auto wait = std::chrono::steady_clock::now() - start;
+    BufferPoolCounters::Add(counters_.latch_waits);
+    BufferPoolCounters::Add(
+        counters_.latch_wait_ns,
+        std::chrono::duration_cast<std::chrono::nanoseconds>(wait).count());
+  }
+  return lock;
+}
+
+/**
+ * 1. search hash table.
+ *  1.1 if exist, pin the page and return immediately, after waiting for the
+ *      thread that is still reading it in
+ *  1.2 if no exist but the page is being written back (by an eviction or by
+ *      the page cleaner), wait and search again
+ *  1.3 if no exist, find a replacement entry from either free list or lru
+ *      replacer. (NOTE: always find from free list first)
+ * 2. Delete the entry for the old page from the hash table and insert an
+ * entry for the new page.
+ * 3. Write the old page back if it is dirty and read the new page content
+ * from disk file without holding the latch, then return page pointer
+ * With a ring, the replacement entry of 1.3 is the oldest frame of the ring
+ * if it can be recycled
+ */
+Page *BufferPoolManagerInstance::FetchPage(page_id_t page_id,
+                                           FrameRing *ring) {
+  assert(page_id != INVALID_PAGE_ID);
+  auto lock = AcquireLatch();
+
+  Page *res = nullptr;
+  while (!page_table_->Find(page_id, res)) {
+    if (writeback_.count(page_id) == 0 && cleaning_.count(page_id) == 0) {
+      res = LoadFrame(lock, page_id, true, ring);
+      if (res != nullptr) {
+        res->last_access_ = ++access_clock_;
+        BufferPoolCounters::Add(counters_.fetch_misses);
+        counters_.AddPinCount(1);
+      }
+      return res;
+    }
+    io_cv_.wait(lock);
+  }
+
+  // mark the Page as pinned
+  ++res->pin_count_;
+  res->last_access_ = ++access_clock_;
+  BufferPoolCounters::Add(counters_.fetch_hits);
+  counters_.AddPinCount(res->pin_count_);
+  // remove its entry from LRUReplacer
+  replacer_->Erase(res);
+  // another thread is still reading it in
+  io_cv_.wait(lock, [res] { return !res->io_in_progress_; });
+  return res;
+}
+
+/*
+ * Implementation of unpin page
+ * if pin_count>0, decrement it and if it becomes zero, put it back to
+ * replacer unless a ring holds it. if pin_count<=0 before this call, return
+ * false. is_dirty: set the dirty flag of this page
+ */
+bool BufferPoolManagerInstance::UnpinPage(page_id_t page_id, bool is_dirty) {
+  assert(page_id != INVALID_PAGE_ID);
+  auto lock = AcquireLatch();
+
+  Page *page;
+  if (page_table_->Find(page_id, page)) {
+    if (page->pin_count_ <= 0) {
+      return false;
+    }
+    if (--page->pin_count_ == 0 && page->ring_ == nullptr) {
+      replacer_->Insert(page);
+    }
+    // a mapped page can not have been changed
+    if (is_dirty && !IsMapped(page)) {
+      page->is_dirty_ = true;
+    }
+    return true;
+  }
+  return false;
+}
+
+/*
+ * Used to flush a particular page of the buffer pool to disk. Should call the
+ * write_page method of the disk manager
+ * if page is not found in page table, return false
+ * NOTE: make sure page_id != INVALID_PAGE_ID
+ */
+bool BufferPoolManagerInstance::FlushPage(page_id_t page_id) {
+  assert(page_id != INVALID_PAGE_ID);
+  auto lock = AcquireLatch();
+
+  Page *page;
+  if (page_table_->Find(page_id, page)) {
+    // content is not there yet, the frame is pinned and stays with page_id
+    io_cv_.wait(lock, [page] { return !page->io_in_progress_; });
+    if (!IsMapped(page)) {
+      disk_manager_->WritePage(page_id, page->GetData());
+    }
+    return true;
+  }
+  return false;
+}
+
+/**
+ * User should call this method for deleting a page. This routine will call
+ * disk manager to deallocate the page. First, if page is found within page
+ * table, buffer pool manager should be responsible for removing this entry out
+ * of page table, resetting page metadata and adding back to free list. Second,
+ * call disk manager's DeallocatePage() method to delete from disk file. If
+ * the page is found within page table, but pin_count != 0, return false.
+ * A page that is not resident is deallocated as well, once a write back of
+ * it in flight is done
+ */
+bool BufferPoolManagerInstance::DeletePage(page_id_t page_id) {
+  assert(page_id != INVALID_PAGE_ID);
+  auto lock = AcquireLatch();
+  io_cv_.wait(lock, [this, page_id] {
+    return writeback_.count(page_id) == 0 && cleaning_.count(page_id) == 0;
+  });
+
+  Page *page;
+  if (page_table_->Find(page_id, page)) {
+    if (page->pin_count_ != 0) {
+      return false;
+    }
+    DropFrame(page);
+  }
+  if (compressed_cache_ != nullptr) {
+    compressed_cache_->Erase(page_id);
+  }
+  disk_manager_->DeallocatePage(page_id);
+  return true;
+}
+
+/*
+ * Used by read-ahead and warm-up: bring page_id in like FetchPage does, but
+ * hand the frame to the replacer right away since nobody has asked for the
+ * page yet. With free_frames_only, the page is only read into a free frame.
+ * A page that is not allocated, e.g. deleted since it was queued, is
+ * skipped. Until EndPrefetch the frame stays pinned and io in progress,
+ * fetchers of page_id wait for it
+ */
+bool BufferPoolManagerInstance::BeginPrefetch(page_id_t page_id,
+                                              FrameRing *ring,
+                                              bool free_frames_only,
+                                              Page *&frame) {
+  assert(page_id != INVALID_PAGE_ID);
+  auto lock = AcquireLatch();
+
+  frame = nullptr;
+  Page *res = nullptr;
+  if (page_table_->Find(page_id, res) || writeback_.count(page_id) != 0 ||
+      cleaning_.count(page_id) != 0 ||
+      (free_frames_only && free_list_->empty()) ||
+      !disk_manager_->IsAllocated(page_id)) {
+    return false;
+  }
+  res = LoadFrame(lock, page_id, true, ring, true);
+  if (res == nullptr) {
+    return false;
+  }
+  if (res->io_in_progress_) {
+    frame = res;
+    return true;
+  }
+  // taken from the compressed cache
+  if (--res->pin_count_ == 0 && res->ring_ == nullptr) {
+    replacer_->Insert(res);
+  }
+  BufferPoolCounters::Add(counters_.prefetches);
+  return true;
+}
+
+void BufferPoolManagerInstance::EndPrefetch(Page *frame) {
+  auto lock = AcquireLatch();
+  frame->io_in_progress_ = false;
+  io_cv_.notify_all();
+  // fetchers that arrived during the read keep their pins
+  if (--frame->pin_count_ == 0 && frame->ring_ == nullptr) {
+    replacer_->Insert(frame);
+  }
+  BufferPoolCounters::Add(counters_.prefetches);
+}
+
+/*
+ * Used by BufferPoolManager::DumpPages, the last access of a frame is set by
+ * FetchPage and NewPage
+ */
+void BufferPoolManagerInstance::GetResidentPages(
+    std::vector<page_id_t> &page_ids) {
+  auto lock = AcquireLatch();
+
+  std::vector<Page *> resident;
+  for (size_t i = 0; i < arena_->GetNumFrames(); ++i) {
+    if (pages_[i].page_id_ != INVALID_PAGE_ID) {
+      resident.push_back(&pages_[i]);
+    }
+  }
+  std::sort(resident.begin(), resident.end(), [](Page *a, Page *b) {
+    return a->last_access_ > b->last_access_;
+  });
+  for (Page *page : resident) {
+    page_ids.push_back(page->page_id_);
+  }
+}
+
+/*
+ * Used by the page cleaner to keep target frames clean and evictable, so
+ * that FetchPage/NewPage rarely have to write back a victim themselves.
+ * Dirty unpinned pages are copied and marked clean under the latch, then
+ * written in page id order without it, adjacent pages together. When
+ * logging is enabled, pages whose log records are not persistent yet are
+ * left alone.
+ * return number of pages written
+ */
+size_t BufferPoolManagerInstance::CleanPages(size_t max_pages, size_t target) {
+  auto lock = AcquireLatch();
+
+  size_t clean = free_list_->size();
+  std::vector<Page *> dirty;
+  for (size_t i = 0; i < arena_->GetNumFrames(); ++i) {
+    Page *page = &pages_[i];
+    if (page->page_id_ == INVALID_PAGE_ID || page->pin_count_ != 0 ||
+        page->io_in_progress_) {
+      continue;
+    }
+    if (!page->is_dirty_) {
+      ++clean;
+    } else if (cleaning_.count(page->page_id_) == 0 &&
+               (!ENABLE_LOGGING || log_manager_ == nullptr ||
+                page->GetLSN() <= log_manager_->GetPersistentLSN())) {
+      dirty.push_back(page);
+    }
+  }
+  if (clean >= target || dirty.empty()) {
+    return 0;
+  }
+
+  std::sort(dirty.begin(), dirty.end(), [](Page *a, Page *b) {
+    return a->page_id_ < b->page_id_;
+  });
+  dirty.resize(std::min({max_pages, target - clean, dirty.size()}));
+  std::vector<page_id_t> page_ids;
+  std::vector<char> buffer(dirty.size() * page_size_);
+  for (size_t i = 0; i < dirty.size(); ++i) {
+    memcpy(&buffer[i * page_size_], dirty[i]->GetData(), page_size_);
+    dirty[i]->is_dirty_ = false;
+    page_ids.push_back(dirty[i]->page_id_);
+    cleaning_.insert(dirty[i]->page_id_);
+  }
+
+  // runs of adjacent pages go to disk in one write
+  lock.unlock();
+  std::vector<const char *> run;
+  for (size_t i = 0; i < page_ids.size(); ++i) {
+    run.push_back(&buffer[i * page_size_]);
+    if (i + 1 == page_ids.size() || page_ids[i + 1] != page_ids[i] + 1) {
+      disk_manager_->WritePages(page_ids[i] - (run.size() - 1), run.data(),
+                                run.size());
+      run.clear();
+    }
+  }
+  lock.lock();
+
+  for (auto page_id : page_ids) {
+    cleaning_.erase(page_id);
+  }
+  BufferPoolCounters::Add(counters_.cleaner_writebacks, page_ids.size());
+  io_cv_.notify_all();
+  return page_ids.size();
+}
+
+/*
+ * First half of BufferPoolManager::FlushAllPages. The copies are taken under
+ * the latch, a pinned page only if its read latch can be taken without
+ * waiting: a writer holding it may be halfway through a change, so such a
+ * page stays dirty for the next flush (waiting for it here could deadlock
+ * with a writer that asks for another page). Copied pages are put into
+ * cleaning_, which keeps the cleaner off them and makes an eviction wait
+ * before writing a newer version, until EndFlush. When logging is enabled,
+ * pages whose log records are not persistent yet stay dirty
+ */
+void BufferPoolManagerInstance::BeginFlush(std::vector<page_id_t> &page_ids,
+                                           std::vector<char> &buffer) {
+  auto lock = AcquireLatch();
+
+  auto writable = [this](Page *page) {
+    return page->page_id_ != INVALID_PAGE_ID && page->is_dirty_ &&
+           (!ENABLE_LOGGING || log_manager_ == nullptr ||
+            page->GetLSN() <= log_manager_->GetPersistentLSN());
+  };
+  // an older copy of a page may still be on its way to disk
+  io_cv_.wait(lock, [this, &writable] {
+    for (size_t i = 0; i < arena_->GetNumFrames(); ++i) {
+      if (writable(&pages_[i]) && cleaning_.count(pages_[i].page_id_) != 0) {
+        return false;
+      }
+    }
+    return true;
+  });
+
+  for (size_t i = 0; i < arena_->GetNumFrames(); ++i) {
+    Page *page = &pages_[i];
+    if (!writable(page)) {
+      continue;
+    }
+    bool pinned = page->pin_count_ != 0;
+    if (pinned && !page->TryRLatch()) {
+      continue;
+    }
+    size_t offset = buffer.size();
+    buffer.resize(offset + page_size_);
+    memcpy(&buffer[offset], page->GetData(), page_size_);
+    if (pinned) {
+      page->RUnlatch();
+    }
+    page->is_dirty_ = false;
+    page_ids.push_back(page->page_id_);
+    cleaning_.insert(page->page_id_);
+  }
+}
+
+/*
+ * Second half of BufferPoolManager::FlushAllPages, called once the copies
+ * are on disk
+ */
+void BufferPoolManagerInstance::EndFlush(
+    const std::vector<page_id_t> &page_ids) {
+  auto lock = AcquireLatch();
+  for (auto page_id : page_ids) {
+    cleaning_.erase(page_id);
+  }
+  io_cv_.notify_all();
+}
+
+/**
+ * Bring a freshly allocated page into this instance. The page id is allocated
+ * by BufferPoolManager, which also decides that it belongs to this instance.
+ * Choose a victim page either from free list or lru replacer(NOTE: always
+ * choose from free list first), update new page's metadata, zero out memory
+ * and add corresponding entry into page table. return nullptr if all the
+ * pages in this instance are pinned
+ */
+Page *BufferPoolManagerInstance::NewPage(page_id_t page_id) {
+  assert(page_id != INVALID_PAGE_ID);
+  auto lock = AcquireLatch();
+
+  // page_id may be the id of a deleted page, whose old copy is still being
+  // written back or resident (e.g. fetched by a stale reader). The old frame
+  // is dropped, unless someone still has it pinned
+  Page *old;
+  while (true) {
+    io_cv_.wait(lock, [this, page_id] {
+      return writeback_.count(page_id) == 0 && cleaning_.count(page_id) == 0;
+    });
+    if (!page_table_->Find(page_id, old)) {
+      break;
+    }
+    if (old->io_in_progress_) {
+      io_cv_.wait(lock, [old, page_id] {
+        return !old->io_in_progress_ || old->page_id_ != page_id;
+      });
+      continue;
+    }
+    if (old->pin_count_ != 0) {
+      return nullptr;
+    }
+    DropFrame(old);
+    break;
+  }
+
+  Page *res = LoadFrame(lock, page_id, false);
+  if (res != nullptr) {
+    res->last_access_ = ++access_clock_;
+    BufferPoolCounters::Add(counters_.new_pages);
+  }
+  return res;
+}
+
+/*
+ * helper function to bring page_id into a ring, free or victim frame. The
+ * frame is pinned and marked io in progress before the latch is dropped for
+ * the writeback of the old page and the read of the new one, so it can not
+ * be chosen as a victim again and fetchers of page_id wait on the frame only.
+ * Fetchers of the old page wait until its writeback has completed and, with
+ * a compressed cache, until it has been put there.
+ * With defer_read, a page that has to come from disk is left to the caller
+ * and the frame is returned with io still in progress.
+ * With mapped reads, a page found in the file mapping is not read at all:
+ * the frame points at the mapped bytes until it is used for another page.
+ * should be called when holding the latch, return with the latch held
+ */
+Page *BufferPoolManagerInstance::LoadFrame(std::unique_lock<std::mutex> &lock,
+                                           page_id_t page_id,
+                                           bool read_from_disk,
+                                           FrameRing *ring, bool defer_read) {
+  Page *res = nullptr;
+  if (ring != nullptr && PickRingFrame(ring, res)) {
+    BufferPoolCounters::Add(counters_.ring_reuses);
+  } else if (!free_list_->empty()) {
+    res = free_list_->front();
+    free_list_->pop_front();
+  } else if (!PickVictim(res)) {
+    return nullptr;
+  }
+  if (ring != nullptr) {
+    AddToRing(ring, res);
+  }
+
+  assert(res->pin_count_ == 0);
+  page_id_t old_page_id = res->page_id_;
+  bool write_back = res->is_dirty_;
+  bool keep = compressed_cache_ != nullptr && old_page_id != INVALID_PAGE_ID;
+  if (write_back || keep) {
+    writeback_.insert(old_page_id);
+  }
+  // delete the entry for old page.
+  page_table_->Remove(old_page_id);
+
+  // insert an entry for the new page.
+  page_table_->Insert(page_id, res);
+
+  // initial meta data, a mapped frame is never dirty nor kept so it gets
+  // its own memory back right away
+  res->data_ = arena_->GetFrameData(res);
+  res->page_id_ = page_id;
+  res->is_dirty_ = false;
+  res->pin_count_ = 1;
+  // a new page may reuse the id of a deleted one
+  if (!read_from_disk && compressed_cache_ != nullptr) {
+    compressed_cache_->Erase(page_id);
+  }
+  if (!write_back && !keep && !read_from_disk) {
+    res->ResetMemory();
+    return res;
+  }
+  const char *mapped_data;
+  if (!write_back && !keep && mapped_reads_ &&
+      (mapped_data = disk_manager_->GetMappedPage(page_id)) != nullptr) {
+    // only read through the mapping, see UnpinPage
+    res->data_ = const_cast<char *>(mapped_data);
+    BufferPoolCounters::Add(counters_.mapped_reads);
+    return res;
+  }
+
+  res->io_in_progress_ = true;
+  // the cleaner may still be writing an older copy of the old page
+  io_cv_.wait(lock, [this, write_back, old_page_id] {
+    return !write_back || cleaning_.count(old_page_id) == 0;
+  });
+  lock.unlock();
+  WriteBack(res, old_page_id, write_back, keep);
+  bool deferred = false;
+  if (read_from_disk) {
+    if (compressed_cache_ != nullptr &&
+        compressed_cache_->Take(page_id, res->GetData())) {
+      BufferPoolCounters::Add(counters_.tier2_hits);
+    } else {
+      if (compressed_cache_ != nullptr) {
+        BufferPoolCounters::Add(counters_.tier2_misses);
+      }
+      if (defer_read) {
+        deferred = true;
+      } else {
+        disk_manager_->ReadPage(page_id, res->GetData());
+      }
+    }
+  } else {
+    res->ResetMemory();
+  }
+  lock.lock();
+
+  if (write_back || keep) {
+    writeback_.erase(old_page_id);
+  }
+  res->io_in_progress_ = deferred;
+  io_cv_.notify_all();
+  return res;
+}
+
+/*
+ * helper function to forget the unpinned page of frame and put the frame
+ * on the free list
+ * should be called when holding the latch
+ */
+void BufferPoolManagerInstance::DropFrame(Page *frame) {
+  assert(frame->pin_count_ == 0);
+  page_table_->Remove(frame->page_id_);
+  replacer_->Erase(frame);
+  frame->page_id_ = INVALID_PAGE_ID;
+  frame->is_dirty_ = false;
+  // the ring skips a frame it no longer owns
+  frame->ring_ = nullptr;
+  free_list_->push_back(frame);
+}
+
+/*
+ * Grow by taking back retired frames first and adding new ones to the arena
+ * after that, every new frame goes to the free list. Shrink by retiring
+ * frames from the free list first and evicting unpinned pages after that.
+ * The page table is rebuilt for the new size when the pool grows. return the
+ * number of frames the instance has now, which is less than pool_size if the
+ * arena is full or more than pool_size if too many frames are pinned
+ */
+size_t BufferPoolManagerInstance::Resize(size_t pool_size) {
+  auto lock = AcquireLatch();
+
+  size_t old_pool_size = pool_size_;
+  while (pool_size_ < pool_size) {
+    Page *frame;
+    if (!retired_.empty()) {
+      frame = retired_.back();
+      retired_.pop_back();
+    } else if ((frame = arena_->AddFrame()) == nullptr) {
+      break;
+    }
+    free_list_->push_back(frame);
+    ++pool_size_;
+  }
+  if (pool_size_ > old_pool_size) {
+    // all readers of the page table hold the latch
+    auto page_table = new LinearProbeHashTable<page_id_t, Page *>(pool_size_);
+    for (size_t i = 0; i < arena_->GetNumFrames(); ++i) {
+      if (pages_[i].page_id_ != INVALID_PAGE_ID) {
+        page_table->Insert(pages_[i].page_id_, &pages_[i]);
+      }
+    }
+    delete page_table_;
+    page_table_ = page_table;
+  }
+
+  while (pool_size_ > pool_size && RetireFrame(lock)) {
+  }
+  replacer_->SetNumFrames(pool_size_);
+  return pool_size_;
+}
+
+/*
+ * helper function to choose a victim from the replacer. When logging is
+ * enabled, prefer a victim that can be written back without forcing the log
+ * should be called when holding the latch
+ */
+bool BufferPoolManagerInstance::PickVictim(Page *&victim) {
+  bool found = false;
+  if (ENABLE_LOGGING && log_manager_ != nullptr) {
+    lsn_t persistent_lsn = log_manager_->GetPersistentLSN();
+    found = replacer_->Victim(victim, [persistent_lsn](Page *const &page) {
+      return !page->is_dirty_ || page->GetLSN() <= persistent_lsn;
+    });
+  }
+  if (!found && !replacer_->Victim(victim)) {
+    return false;
+  }
+  BufferPoolCounters::Add(counters_.evictions);
+  return true;
+}
+
+/*
+ * helper function to save the old page of an evicted frame: write it back if
+ * it is dirty and put it into the compressed cache if keep
+ * should be called without the latch
+ */
+void BufferPoolManagerInstance::WriteBack(Page *frame, page_id_t old_page_id,
+                                          bool write_back, bool keep) {
+  if (write_back) {
+    BufferPoolCounters::Add(counters_.writebacks);
+    // WAL: the log records of the page have to reach the disk first
+    if (ENABLE_LOGGING && log_manager_ != nullptr &&
+        frame->GetLSN() > log_manager_->GetPersistentLSN()) {
+      BufferPoolCounters::Add(counters_.wal_waits);
+      log_manager_->WaitUntilPersistent(frame->GetLSN());
+    }
+    disk_manager_->WritePage(old_page_id, frame->GetData());
+  }
+  if (keep) {
+    size_t size = compressed_cache_->Insert(old_page_id, frame->GetData());
+    if (size != 0) {
+      BufferPoolCounters::Add(counters_.tier2_bytes_in, page_size_);
+      BufferPoolCounters::Add(counters_.tier2_bytes_out, size);
+    }
+  }
+}
+
+/*
+ * helper function to take one frame out of use, a free one if there is any,
+ * else an unpinned victim whose page is saved like in LoadFrame. The memory
+ * of the frame goes back to the OS. return false if every frame is pinned
+ * should be called when holding the latch, return with the latch held
+ */
+bool BufferPoolManagerInstance::RetireFrame(
+    std::unique_lock<std::mutex> &lock) {
+  Page *frame = nullptr;
+  if (!free_list_->empty()) {
+    frame = free_list_->back();
+    free_list_->pop_back();
+  } else if (PickVictim(frame)) {
+    assert(frame->pin_count_ == 0);
+    page_id_t old_page_id = frame->page_id_;
+    bool write_back = frame->is_dirty_;
+    bool keep = compressed_cache_ != nullptr;
+    page_table_->Remove(old_page_id);
+    // no longer reachable, nobody but us touches the frame from here on
+    frame->page_id_ = INVALID_PAGE_ID;
+    frame->is_dirty_ = false;
+
+    if (write_back || keep) {
+      writeback_.insert(old_page_id);
+      io_cv_.wait(lock, [this, write_back, old_page_id] {
+        return !write_back || cleaning_.count(old_page_id) == 0;
+      });
+      lock.unlock();
+      WriteBack(frame, old_page_id, write_back, keep);
+      lock.lock();
+      writeback_.erase(old_page_id);
+      io_cv_.notify_all();
+    }
+  } else {
+    return false;
+  }
+
+  arena_->ReleaseFrame(frame);
+  retired_.push_back(frame);
+  --pool_size_;
+  return true;
+}
+
+/*
+ * Called when an access strategy goes away. Frames still held by the ring
+ * go to the replacer, or to whoever unpins them last
+ */
+void BufferPoolManagerInstance::ReleaseRing(FrameRing *ring) {
+  auto lock = AcquireLatch();
+  for (Page *frame : ring->frames) {
+    RemoveFromRing(ring, frame);
+  }
+  ring->frames.clear();
+  ring->next = 0;
+}
+
+/*
+ * helper function to recycle the oldest frame of a full ring. Only an
+ * unpinned frame the ring still owns qualifies, and when logging is enabled
+ * only if it can be written back without forcing the log
+ * should be called when holding the latch
+ */
+bool BufferPoolManagerInstance::PickRingFrame(FrameRing *ring, Page *&frame) {
+  if (ring->frames.size() < ring->capacity) {
+    return false;
+  }
+  Page *oldest = ring->frames[ring->next];
+  if (oldest->ring_ != ring || oldest->pin_count_ != 0) {
+    return false;
+  }
+  if (ENABLE_LOGGING && log_manager_ != nullptr && oldest->is_dirty_ &&
+      oldest->GetLSN() > log_manager_->GetPersistentLSN()) {
+    return false;
+  }
+  frame = oldest;
+  return true;
+}
+
+/*
+ * helper function to put frame into the slot of the oldest frame, which
+ * leaves the ring unless it is frame itself
+ * should be called when holding the latch
+ */
+void BufferPoolManagerInstance::AddToRing(FrameRing *ring, Page *frame) {
+  frame->ring_ = ring;
+  if (ring->frames.size() < ring->capacity) {
+    ring->frames.push_back(frame);
+    return;
+  }
+  Page *oldest = ring->frames[ring->next];
+  if (oldest != frame) {
+    RemoveFromRing(ring, oldest);
+  }
+  ring->frames[ring->next] = frame;
+  ring->next = (ring->next + 1) % ring->capacity;
+}
+
+/*
+ * helper function to let go of a frame of the ring, an unpinned one is
+ * evictable from now on
+ * should be called when holding the latch
+ */
+void BufferPoolManagerInstance::RemoveFromRing(FrameRing *ring, Page *frame) {
+  if (frame->ring_ != ring) {
+    return;
+  }
+  frame->ring_ = nullptr;
+  if (frame->pin_count_ == 0) {
+    replacer_->Insert(frame);
+  }
+}
+
+} // namespace cmudb
@@ -0,0 +1,98 @@
+/**
+ * CLOCK implementation
+ */
+#include <cassert>
+
+#include "buffer/clock_replacer.h"
+#include "page/page.h"
+
+namespace cmudb {
+
+template <typename T>
+ClockReplacer<T>::ClockReplacer(size_t num_frames, T base)
+    : num_frames_(num_frames), base_(base),
+      frames_(new std::atomic<uint8_t>[num_frames]), hand_(0) {
+  for (size_t i = 0; i < num_frames_; ++i) {
+    frames_[i].store(0, std::memory_order_relaxed);
+  }
+}
+
+template <typename T> ClockReplacer<T>::~ClockReplacer() = default;
+
+/*
+ * Mark value as evictable and recently used
+ */
+template <typename T> void ClockReplacer<T>::Insert(const T &value) {
+  size_t frame_id = FrameId(value);
+  assert(frame_id < num_frames_);
+  frames_[frame_id].store(EVICTABLE | REFERENCED, std::memory_order_release);
+}
+
+/*
+ * Sweep the clock hand, giving every referenced frame a second chance. Two
+ * full rotations clear all referenced bits, so if no frame is found by then
+ * nothing is evictable.
+ */
+template <typename T> bool ClockReplacer<T>::Victim(T &value) {
+  return Victim(value, VictimFilter<T>());
+}
+
+/*
+ * Same sweep, frames rejected by filter are passed over like pinned ones but
+ * still lose their referenced bit
+ */
+template <typename T>
+bool ClockReplacer<T>::Victim(T &value, const VictimFilter<T> &filter) {
+  std::lock_guard<std::mutex> lock(hand_latch_);
+
+  for (size_t i = 0; i < 2 * num_frames_; ++i) {
+    size_t frame_id = hand_;
+    hand_ = (hand_ + 1) % num_frames_;
+
+    uint8_t state = frames_[frame_id].load(std::memory_order_acquire);
+    if (!(state & EVICTABLE)) {
+      continue;
+    }
+    if (state & REFERENCED) {
+      // second chance, lost if the frame is pinned meanwhile
+      frames_[frame_id].compare_exchange_strong(state, EVICTABLE);
+      continue;
+    }
+    if (filter && !filter(base_ + frame_id)) {
+      continue;
+    }
+    if (frames_[frame_id].compare_exchange_strong(state, 0)) {
+      value = base_ + frame_id;
+      return true;
+    }
+  }
+  return false;
+}
+
+/*
+ * Mark value as not evictable. return true if it was evictable
+ */
+template <typename T> bool ClockReplacer<T>::Erase(const T &value) {
+  size_t frame_id = FrameId(value);
+  assert(frame_id < num_frames_);
+  return frames_[frame_id].exchange(0, std::memory_order_acq_rel) & EVICTABLE;
+}
+
+/*
+ * Number of evictable frames, linear in the number of frames
+ */
+template <typename T> size_t ClockReplacer<T>::Size() {
+  size_t size = 0;
+  for (size_t i = 0; i < num_frames_; ++i) {
+    if (frames_[i].load(std::memory_order_relaxed) & EVICTABLE) {
+      ++size;
+    }
+  }
+  return size;
+}
+
+template class ClockReplacer<Page *>;
+// test only
+template class ClockReplacer<int>;
+
+} // namespace cmudb
@@ -0,0 +1,200 @@
+/**
+ * compressed_cache.cpp
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+
+#include "buffer/compressed_cache.h"
+
+namespace cmudb {
+
+/*
+ * Codec format, a sequence of tokens:
+ *   t < 0x80: t + 1 literal bytes follow
+ *   t >= 0x80: copy (t & 0x7f) + MIN_MATCH bytes starting offset bytes back,
+ *              offset follows as two bytes, low byte first
+ * Offsets fit in two bytes since pages are at most MAX_PAGE_SIZE bytes
+ */
+static const size_t MIN_MATCH = 4;
+static const size_t MAX_MATCH = 0x7f + MIN_MATCH;
+static const size_t MAX_LITERALS = 0x80;
+static const size_t MAX_OFFSET = 0xffff;
+static const int HASH_BITS = 12;
+static const uint32_t NO_POSITION = UINT32_MAX;
+
+CompressedCache::CompressedCache(size_t capacity, size_t page_size)
+    : capacity_(capacity), page_size_(page_size), bytes_(0) {}
+
+size_t CompressedCache::Insert(page_id_t page_id, const char *page_data) {
+  // compress before taking the latch. The entry is copied out of the scratch
+  // buffer so that its capacity is what bytes_ accounts for
+  std::vector<char> scratch(MaxCompressedSize(page_size_));
+  size_t size = Compress(page_data, page_size_, scratch.data());
+  bool raw = size >= page_size_;
+  if (raw) {
+    size = page_size_;
+  }
+  const char *source = raw ? page_data : scratch.data();
+  std::vector<char> buffer(source, source + size);
+
+  std::lock_guard<std::mutex> lock(latch_);
+  auto found = index_.find(page_id);
+  if (found != index_.end()) {
+    Remove(found->second);
+  }
+  if (size > capacity_) {
+    return 0;
+  }
+  while (bytes_ + size > capacity_) {
+    Remove(std::prev(lru_.end()));
+  }
+  lru_.push_front(Entry{page_id, raw, std::move(buffer)});
+  index_[page_id] = lru_.begin();
+  bytes_ += size;
+  return size;
+}
+
+bool CompressedCache::Take(page_id_t page_id, char *page_data) {
+  Entry entry;
+  {
+    std::lock_guard<std::mutex> lock(latch_);
+    auto found = index_.find(page_id);
+    if (found == index_.end()) {
+      return false;
+    }
+    entry = std::move(*found->second);
+    bytes_ -= entry.data.size();
+    lru_.erase(found->second);
+    index_.erase(found);
+  }
+
+  if (entry.raw) {
+    memcpy(page_data, entry.data.data(), page_size_);
+    return true;
+  }
+  return Decompress(entry.data.data(), entry.data.size(), page_data,
+                    page_size_);
+}
+
+void CompressedCache::Erase(page_id_t page_id) {
+  std::lock_guard<std::mutex> lock(latch_);
+  auto found = index_.find(page_id);
+  if (found != index_.end()) {
+    Remove(found->second);
+  }
+}
+
+size_t CompressedCache::Size() {
+  std::lock_guard<std::mutex> lock(latch_);
+  return index_.size();
+}
+
+size_t CompressedCache::GetBytes() {
+  std::lock_guard<std::mutex> lock(latch_);
+  return bytes_;
+}
+
+void CompressedCache::Remove(iterator_type it) {
+  bytes_ -= it->data.size();
+  index_.erase(it->page_id);
+  lru_.erase(it);
+}
+
+/*
+ * Worst case is all literals, one extra byte per MAX_LITERALS of input
+ */
+size_t CompressedCache::MaxCompressedSize(size_t size) {
+  return size + (size + MAX_LITERALS - 1) / MAX_LITERALS;
+}
+
+/*
+ * Greedy LZ77: a hash of the next MIN_MATCH bytes remembers where they were
+ * seen last, a match is extended as far as it goes. Zero filled and
+ * repetitive pages shrink to a few bytes per MAX_MATCH bytes of input
+ */
+size_t CompressedCache::Compress(const char *src, size_t size, char *dst) {
+  assert(size <= MAX_OFFSET + 1);
+  auto in = reinterpret_cast<const unsigned char *>(src);
+  auto out = reinterpret_cast<unsigned char *>(dst);
+  uint32_t table[1 << HASH_BITS];
+  std::fill(table, table + (1 << HASH_BITS), NO_POSITION);
+
+  size_t pos = 0, out_pos = 0, literal_start = 0;
+  auto emit_literals = [&](size_t end) {
+    while (literal_start < end) {
+      size_t run = std::min(MAX_LITERALS, end - literal_start);
+      out[out_pos++] = static_cast<unsigned char>(run - 1);
+      memcpy(out + out_pos, in + literal_start, run);
+      out_pos += run;
+      literal_start += run;
+    }
+  };
+
+  while (pos + MIN_MATCH <= size) {
+    uint32_t word;
+    memcpy(&word, in + pos, MIN_MATCH);
+    uint32_t hash = (word * 2654435761u) >> (32 - HASH_BITS);
+    uint32_t candidate = table[hash];
+    table[hash] = static_cast<uint32_t>(pos);
+    if (candidate == NO_POSITION || pos - candidate > MAX_OFFSET ||
+        memcmp(in + candidate, in + pos, MIN_MATCH) != 0) {
+      ++pos;
+      continue;
+    }
+
+    size_t length = MIN_MATCH;
+    while (pos + length < size && length < MAX_MATCH &&
+           in[candidate + length] == in[pos + length]) {
+      ++length;
+    }
+    emit_literals(pos);
+    size_t offset = pos - candidate;
+    out[out_pos++] = static_cast<unsigned char>(0x80 | (length - MIN_MATCH));
+    out[out_pos++] = static_cast<unsigned char>(offset & 0xff);
+    out[out_pos++] = static_cast<unsigned char>(offset >> 8);
+    pos += length;
+    literal_start = pos;
+  }
+  emit_literals(size);
+  return out_pos;
+}
+
+bool CompressedCache::Decompress(const char *src, size_t size, char *dst,
+                                 size_t dst_size) {
+  auto in = reinterpret_cast<const unsigned char *>(src);
+  auto out = reinterpret_cast<unsigned char *>(dst);
+  size_t pos = 0, out_pos = 0;
+  while (pos < size) {
+    unsigned char token = in[pos++];
+    if (token < 0x80) {
+      size_t run = token + 1u;
+      if (pos + run > size || out_pos + run > dst_size) {
+        return false;
+      }
+      memcpy(out + out_pos, in + pos, run);
+      pos += run;
+      out_pos += run;
+      continue;
+    }
+    if (pos + 2 > size) {
+      return false;
+    }
+    size_t length = (token & 0x7f) + MIN_MATCH;
+    size_t offset = in[pos] | (static_cast<size_t>(in[pos + 1]) << 8);
+    pos += 2;
+    if (offset == 0 || offset > out_pos || out_pos + length > dst_size) {
+      return false;
+    }
+    // the source may overlap what is being written, copy byte by byte
+    for (size_t i = 0; i < length; ++i, ++out_pos) {
+      out[out_pos] = out[out_pos - offset];
+    }
+  }
+  return out_pos == dst_size;
+}
+
+} // namespace cmudb
@@ -0,0 +1,124 @@
+/**
+ * frame_arena.cpp
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+#include <new>
+#include <sys/mman.h>
+
+#include "buffer/frame_arena.h"
+#include "common/exception.h"
+
+namespace cmudb {
+
+static const size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+/*
+ * Commit the huge pages backing bytes [begin, end) of a MAP_NORESERVE huge
+ * page mapping. Fails instead of raising SIGBUS later when the huge page
+ * pool has run dry, or when the kernel can not populate a range (before
+ * Linux 5.14)
+ */
+static bool PopulateHugePages(char *data, size_t begin, size_t end) {
+#ifdef MADV_POPULATE_WRITE
+  begin = begin / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+  end = (end + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+  return begin == end ||
+         madvise(data + begin, end - begin, MADV_POPULATE_WRITE) == 0;
+#else
+  return false;
+#endif
+}
+
+FrameArena::FrameArena(size_t num_frames, size_t page_size,
+                       bool use_huge_pages, size_t max_frames)
+    : num_frames_(0), max_frames_(std::max(num_frames, max_frames)),
+      page_size_(page_size), huge_tlb_(false), data_(nullptr),
+      frames_(nullptr) {
+  size_t bytes = max_frames_ * page_size_;
+  void *data = MAP_FAILED;
+
+#ifdef MAP_HUGETLB
+  if (use_huge_pages) {
+    mapping_size_ = (bytes + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE *
+                    HUGE_PAGE_SIZE;
+    // reserve huge pages only for the frames in use, a pool that may grow
+    // eightfold rarely fits the huge page pool up front
+    data = mmap(nullptr, mapping_size_, PROT_READ | PROT_WRITE,
+                MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | MAP_NORESERVE, -1,
+                0);
+    if (data != MAP_FAILED &&
+        !PopulateHugePages(static_cast<char *>(data), 0,
+                           num_frames * page_size_)) {
+      munmap(data, mapping_size_);
+      data = MAP_FAILED;
+    }
+    huge_tlb_ = data != MAP_FAILED;
+  }
+#endif
+  if (data == MAP_FAILED) {
+    // no huge pages reserved, fall back to regular pages and let the kernel
+    // promote them transparently if it can. only touched pages take memory
+    mapping_size_ = bytes;
+    data = mmap(nullptr, mapping_size_, PROT_READ | PROT_WRITE,
+                MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (data == MAP_FAILED) {
+      throw std::bad_alloc();
+    }
+#ifdef MADV_HUGEPAGE
+    if (use_huge_pages) {
+      madvise(data, mapping_size_, MADV_HUGEPAGE);
+    }
+#endif
+  }
+  data_ = static_cast<char *>(data);
+
+  // aligned new is not available before C++17. descriptors are only
+  // constructed when their frame is added
+  void *frames;
+  if (posix_memalign(&frames, alignof(Page), max_frames_ * sizeof(Page)) !=
+      0) {
+    munmap(data_, mapping_size_);
+    throw std::bad_alloc();
+  }
+  frames_ = static_cast<Page *>(frames);
+  for (size_t i = 0; i < num_frames; ++i) {
+    AddFrame();
+  }
+}
+
+FrameArena::~FrameArena() {
+  for (size_t i = 0; i < num_frames_; ++i) {
+    frames_[i].~Page();
+  }
+  free(frames_);
+  munmap(data_, mapping_size_);
+}
+
+Page *FrameArena::AddFrame() {
+  if (num_frames_ == max_frames_) {
+    return nullptr;
+  }
+  if (huge_tlb_ && !PopulateHugePages(data_, num_frames_ * page_size_,
+                                      (num_frames_ + 1) * page_size_)) {
+    return nullptr;
+  }
+  Page *frame = &frames_[num_frames_];
+  // anonymous memory is zero filled, no need to reset
+  new (frame) Page();
+  frame->data_ = data_ + num_frames_ * page_size_;
+  frame->page_size_ = page_size_;
+  ++num_frames_;
+  return frame;
+}
+
+void FrameArena::ReleaseFrame(Page *frame) {
+  assert(frame >= frames_ && frame < frames_ + num_frames_);
+  frame->data_ = GetFrameData(frame);
+  // best effort, a huge page can not be given back piecewise
+  madvise(frame->data_, page_size_, MADV_DONTNEED);
+}
+
+} // namespace cmudb
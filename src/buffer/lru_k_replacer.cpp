@@ -0,0 +1,130 @@
+/**
+ * LRU-K implementation
+ */
+#include <cassert>
+
+#include "buffer/lru_k_replacer.h"
+#include "page/page.h"
+
+namespace cmudb {
+
+template <typename T>
+LRUKReplacer<T>::LRUKReplacer(size_t k) : k_(k), current_timestamp_(0) {
+  assert(k_ > 0);
+}
+
+template <typename T> LRUKReplacer<T>::~LRUKReplacer() = default;
+
+/*
+ * Record an access of the page held by value and make value evictable
+ */
+template <typename T> void LRUKReplacer<T>::Insert(const T &value) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  key_type key = ReplacerKey<T>::Get(value);
+
+  auto frame = frames_.find(value);
+  if (frame != frames_.end()) {
+    auto &old_history = history_[frame->second];
+    Detach(value, old_history);
+    // frame was recycled without being victimized (e.g. page deleted)
+    if (frame->second != key) {
+      history_.erase(frame->second);
+      frame->second = key;
+    }
+  } else {
+    frames_.emplace(value, key);
+  }
+
+  auto &history = history_[key];
+  history.push_back(++current_timestamp_);
+  if (history.size() > k_) {
+    history.pop_front();
+  }
+  Attach(value, history);
+}
+
+/*
+ * Evict the value with the largest backward k-distance
+ */
+template <typename T> bool LRUKReplacer<T>::Victim(T &value) {
+  return Victim(value, VictimFilter<T>());
+}
+
+/*
+ * Evict the value with the largest backward k-distance among those accepted
+ * by filter
+ */
+template <typename T>
+bool LRUKReplacer<T>::Victim(T &value, const VictimFilter<T> &filter) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (queue_type *queue : {&cold_, &hot_}) {
+    for (auto it = queue->begin(); it != queue->end(); ++it) {
+      if (filter && !filter(it->second)) {
+        continue;
+      }
+      value = it->second;
+      queue->erase(it);
+      auto frame = frames_.find(value);
+      assert(frame != frames_.end());
+      history_.erase(frame->second);
+      frames_.erase(frame);
+      return true;
+    }
+  }
+  return false;
+}
+
+/*
+ * Make value not evictable, its history is kept. return true if value was
+ * evictable
+ */
+template <typename T> bool LRUKReplacer<T>::Erase(const T &value) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto frame = frames_.find(value);
+  if (frame == frames_.end()) {
+    return false;
+  }
+  auto &history = history_[frame->second];
+  size_t size = cold_.size() + hot_.size();
+  Detach(value, history);
+  return size != cold_.size() + hot_.size();
+}
+
+template <typename T> size_t LRUKReplacer<T>::Size() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return cold_.size() + hot_.size();
+}
+
+/*
+ * helper functions to take value out of / put value into the eviction queues
+ * should be called when holding the lock
+ */
+template <typename T>
+void LRUKReplacer<T>::Detach(const T &value,
+                             const std::deque<uint64_t> &history) {
+  if (history.empty()) {
+    return;
+  }
+  if (history.size() < k_) {
+    cold_.erase(std::make_pair(history.front(), value));
+  } else {
+    hot_.erase(std::make_pair(history.front(), value));
+  }
+}
+
+template <typename T>
+void LRUKReplacer<T>::Attach(const T &value,
+                             const std::deque<uint64_t> &history) {
+  assert(!history.empty());
+  if (history.size() < k_) {
+    cold_.emplace(history.front(), value);
+  } else {
+    hot_.emplace(history.front(), value);
+  }
+}
+
+template class LRUKReplacer<Page *>;
+// test only
+template class LRUKReplacer<int>;
+
+} // namespace cmudb
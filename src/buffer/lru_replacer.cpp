@@ -48,25 +48,26 @@ template <typename T> void LRUReplacer<T>::Insert(const T &value) {
  * return true. If LRU is empty, return false
  */
 template <typename T> bool LRUReplacer<T>::Victim(T &value) {
-  std::lock_guard<std::mutex> lock(mutex_);
-
-  if (size_ == 0) {
-    assert(head_.get() == tail_);
-    return false;
-  }
+  return Victim(value, VictimFilter<T>());
+}
 
-  value = head_->next->data;
-  head_->next = std::move(head_->next->next);
-  if (head_->next != nullptr) {
-    head_->next->pre = head_.get();
-  }
+/*
+ * Pop the least recently used member accepted by filter
+ */
+template <typename T>
+bool LRUReplacer<T>::Victim(T &value, const VictimFilter<T> &filter) {
+  std::lock_guard<std::mutex> lock(mutex_);
 
-  table_.erase(value);
-  if (--size_ == 0) {
-    tail_ = head_.get();   // reset tail
+  for (node *cur = head_->next.get(); cur != nullptr; cur = cur->next.get()) {
+    if (!filter || filter(cur->data)) {
+      value = cur->data;
+      Unlink(cur);
+      check();
+      return true;
+    }
   }
-  check();
-  return true;
+  assert(size_ != 0 || head_.get() == tail_);
+  return false;
 }
 
 /*
@@ -78,20 +79,7 @@ template <typename T> bool LRUReplacer<T>::Erase(const T &value) {
 
   auto it = table_.find(value);
   if (it != table_.end()) {
-    if (it->second != tail_) {
-      node *pre = it->second->pre;
-      std::unique_ptr<node> cur = std::move(pre->next);
-      pre->next = std::move(cur->next);
-      pre->next->pre = pre;
-    } else {
-      tail_ = tail_->pre;
-      tail_->next.release();
-    }
-
-    table_.erase(value);
-    if (--size_ == 0) {
-      tail_ = head_.get();  // reset tail
-    }
+    Unlink(it->second);
     check();
     return true;
   }
@@ -103,6 +91,26 @@ template <typename T> size_t LRUReplacer<T>::Size() {
   return size_;
 }
 
+/*
+ * helper function to remove a node from the list and the table
+ * should be called when holding the lock
+ */
+template <typename T> void LRUReplacer<T>::Unlink(node *cur) {
+  table_.erase(cur->data);
+  if (cur != tail_) {
+    node *pre = cur->pre;
+    std::unique_ptr<node> owner = std::move(pre->next);
+    pre->next = std::move(owner->next);
+    pre->next->pre = pre;
+  } else {
+    tail_ = tail_->pre;
+    tail_->next.reset();
+  }
+  if (--size_ == 0) {
+    tail_ = head_.get(); // reset tail
+  }
+}
+
 // for debug: should be called when holding the lock
 template <typename T> void LRUReplacer<T>::check() {
   node *pointer = head_.get();
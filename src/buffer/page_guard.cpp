@@ -0,0 +1,73 @@
+/**
+ * page_guard.cpp
+ */
+
+#include <utility>
+
+#include "buffer/page_guard.h"
+#include "buffer/buffer_pool_manager.h"
+
+namespace cmudb {
+
+PageGuard::PageGuard(BufferPoolManager *buffer_pool_manager, Page *page)
+    : buffer_pool_manager_(buffer_pool_manager), page_(page) {}
+
+PageGuard::PageGuard(PageGuard &&other) noexcept
+    : buffer_pool_manager_(other.buffer_pool_manager_), page_(other.page_),
+      is_dirty_(other.is_dirty_) {
+  other.page_ = nullptr;
+  other.is_dirty_ = false;
+}
+
+PageGuard &PageGuard::operator=(PageGuard &&other) noexcept {
+  if (this != &other) {
+    Release();
+    buffer_pool_manager_ = other.buffer_pool_manager_;
+    page_ = other.page_;
+    is_dirty_ = other.is_dirty_;
+    other.page_ = nullptr;
+    other.is_dirty_ = false;
+  }
+  return *this;
+}
+
+void PageGuard::Release() {
+  if (page_ == nullptr) {
+    return;
+  }
+  buffer_pool_manager_->UnpinPage(page_->GetPageId(), is_dirty_);
+  page_ = nullptr;
+  is_dirty_ = false;
+}
+
+ReadPageGuard &ReadPageGuard::operator=(ReadPageGuard &&other) noexcept {
+  if (this != &other) {
+    Release();
+    guard_ = std::move(other.guard_);
+  }
+  return *this;
+}
+
+void ReadPageGuard::Release() {
+  if (guard_) {
+    guard_.GetPage()->RUnlatch();
+    guard_.Release();
+  }
+}
+
+WritePageGuard &WritePageGuard::operator=(WritePageGuard &&other) noexcept {
+  if (this != &other) {
+    Release();
+    guard_ = std::move(other.guard_);
+  }
+  return *this;
+}
+
+void WritePageGuard::Release() {
+  if (guard_) {
+    guard_.GetPage()->WUnlatch();
+    guard_.Release();
+  }
+}
+
+} // namespace cmudb
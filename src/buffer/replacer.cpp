@@ -0,0 +1,13 @@
+/**
+ * replacer.cpp
+ */
+#include "buffer/replacer.h"
+#include "page/page.h"
+
+namespace cmudb {
+
+page_id_t ReplacerKey<Page *>::Get(Page *const &value) {
+  return value->GetPageId();
+}
+
+} // namespace cmudb
@@ -4,4 +4,8 @@ namespace cmudb {
   std::atomic<bool> ENABLE_LOGGING(false);  // for virtual table
   std::chrono::duration<long long int> LOG_TIMEOUT =
    std::chrono::seconds(1);
+  std::chrono::milliseconds PAGE_CLEANER_INTERVAL =
+   std::chrono::milliseconds(100);
+  std::chrono::milliseconds PAGE_DUMP_INTERVAL =
+   std::chrono::milliseconds(60000);
 }
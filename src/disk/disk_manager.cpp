@@ -1,12 +1,24 @@
 /**
  * disk_manager.cpp
  */
+#include <algorithm>
 #include <assert.h>
+#include <cerrno>
+#include <climits>
+#include <cstdint>
+#include <cstdlib>
 #include <cstring>
+#include <fcntl.h>
 #include <iostream>
+#include <memory>
+#include <sys/mman.h>
 #include <sys/stat.h>
+#include <sys/uio.h>
 #include <thread>
+#include <unistd.h>
+#include <vector>
 
+#include "common/exception.h"
 #include "common/logger.h"
 #include "disk/disk_manager.h"
 
@@ -14,13 +26,29 @@ namespace cmudb {
 
 static char *buffer_used = nullptr;
 
+// superblock layout: magic (8) | version (4) | page size (4)
+static const char SUPERBLOCK_MAGIC[8] = {'C', 'M', 'U', 'D', 'B', 'S', 'B', '1'};
+// version 2 files keep a bitmap page in front of every group of pages
+static const uint32_t SUPERBLOCK_VERSION = 2;
+static const uint32_t SUPERBLOCK_VERSION_NO_BITMAPS = 1;
+
 /**
  * Constructor: open/create a single database file & log file
  * @input db_file: database file name
+ * @input page_size: page size of a newly created database file, an existing
+ * file keeps the page size recorded in its superblock
+ * @input direct_io: open the database file with O_DIRECT if possible
+ * @input backend: backend of the asynchronous calls, PREAD if io_uring can't
+ * be set up
  */
-DiskManager::DiskManager(const std::string &db_file)
-    : file_name_(db_file), next_page_id_(0), num_flushes_(0), flush_log_(false),
-      flush_log_f_(nullptr) {
+DiskManager::DiskManager(const std::string &db_file, size_t page_size,
+                         bool direct_io, IOBackend backend)
+    : db_fd_(-1), direct_io_(false), log_fd_(-1), log_size_(0),
+      file_name_(db_file),
+      page_size_(page_size), data_offset_(0), map_data_(nullptr),
+      map_size_(0), map_advice_(MADV_NORMAL), num_map_users_(0),
+      num_writers_(0), next_page_id_(0),
+      num_flushes_(0), flush_log_(false), flush_log_f_(nullptr) {
   std::string::size_type n = file_name_.find(".");
   if (n == std::string::npos) {
     LOG_DEBUG("wrong file format");
@@ -41,22 +69,49 @@ DiskManager::DiskManager(const std::string &db_file)
     log_io_.open(log_name_, std::ios::binary | std::ios::in | std::ios::app |
                                 std::ios::out);
   }
+  log_fd_ = open(log_name_.c_str(), O_WRONLY);
+  log_size_ = std::max<long long>(0, GetFileSize(log_name_));
 
-  db_io_.open(db_file,
-              std::ios::binary | std::ios::in | std::ios::out | std::ios::out);
-  // directory or file does not exist
-  if (!db_io_.is_open()) {
-    db_io_.clear();
-    // create a new file
-    db_io_.open(db_file, std::ios::binary | std::ios::trunc | std::ios::out);
-    db_io_.close();
-    // reopen with original mode
-    db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
+  // create the file if it does not exist
+  db_fd_ = open(db_file.c_str(), O_RDWR | O_CREAT, 0644);
+  if (db_fd_ == -1) {
+    LOG_DEBUG("can't open db file");
+    return;
+  }
+
+  if (GetFileSize(file_name_) > 0) {
+    ReadSuperblock();
+  } else {
+    WriteSuperblock();
+  }
+  // the superblock is read and written buffered, its page size decides
+  // whether direct I/O is possible at all
+  if (direct_io) {
+    EnableDirectIO();
+  }
+
+  if (backend == IOBackend::IO_URING) {
+    io_uring_.reset(new IoUring(IO_URING_QUEUE_DEPTH));
+    if (!io_uring_->IsAvailable()) {
+      io_uring_.reset();
+    }
   }
 }
 
 DiskManager::~DiskManager() {
-  db_io_.close();
+  // waits for the requests in flight
+  io_uring_.reset();
+  // pages served from a mapping are gone with the buffer pools by now
+  for (auto &mapping : mappings_) {
+    munmap(mapping.first, mapping.second);
+  }
+  if (db_fd_ != -1) {
+    WriteBitmaps();
+    close(db_fd_);
+  }
+  if (log_fd_ != -1) {
+    close(log_fd_);
+  }
   log_io_.close();
 }
 
@@ -64,39 +119,224 @@ DiskManager::~DiskManager() {
  * Write the contents of the specified page into disk file
  */
 void DiskManager::WritePage(page_id_t page_id, const char *page_data) {
-  size_t offset = page_id * PAGE_SIZE;
-  // set write cursor to offset
-  db_io_.seekp(offset);
-  db_io_.write(page_data, PAGE_SIZE);
-  // check for I/O error
-  if (db_io_.bad()) {
+  WriteBitmaps();
+  size_t offset = PageOffset(page_id);
+  if (!PWrite(page_data, page_size_, offset)) {
     LOG_DEBUG("I/O error while writing");
+  }
+}
+
+/**
+ * Read a run of consecutive pages. Like ReadPage, the pages past the end of
+ * the file are zero filled. Buffers unfit for direct I/O are read one by one
+ */
+void DiskManager::ReadPages(page_id_t first_page_id, char *const *pages_data,
+                            size_t num_pages) {
+  // a run is split where it crosses into the next group
+  size_t run = GetRunLength(first_page_id, num_pages);
+  if (run < num_pages) {
+    ReadPages(first_page_id, pages_data, run);
+    ReadPages(first_page_id + run, pages_data + run, num_pages - run);
     return;
   }
-  // needs to flush to keep disk file in sync
-  db_io_.flush();
+  if (!std::all_of(pages_data, pages_data + num_pages,
+                   [this](const char *data) { return IsAligned(data); })) {
+    for (size_t i = 0; i < num_pages; ++i) {
+      ReadPage(first_page_id + i, pages_data[i]);
+    }
+    return;
+  }
+
+  std::vector<struct iovec> iov(num_pages);
+  for (size_t i = 0; i < num_pages; ++i) {
+    iov[i].iov_base = pages_data[i];
+    iov[i].iov_len = page_size_;
+  }
+  size_t offset = PageOffset(first_page_id);
+  size_t read_count = VectoredIO(false, iov.data(), num_pages, offset);
+  if (read_count < num_pages * page_size_) {
+    LOG_DEBUG("Read less than a page");
+    for (size_t i = read_count / page_size_; i < num_pages; ++i) {
+      size_t done = std::max(read_count, i * page_size_) - i * page_size_;
+      memset(pages_data[i] + done, 0, page_size_ - done);
+    }
+  }
+}
+
+/**
+ * Write a run of consecutive pages. Nothing is synced, so a caller writing
+ * several runs pays for one Sync at the end
+ */
+void DiskManager::WritePages(page_id_t first_page_id,
+                             const char *const *pages_data, size_t num_pages) {
+  size_t run = GetRunLength(first_page_id, num_pages);
+  if (run < num_pages) {
+    WritePages(first_page_id, pages_data, run);
+    WritePages(first_page_id + run, pages_data + run, num_pages - run);
+    return;
+  }
+  WriteBitmaps();
+  if (!std::all_of(pages_data, pages_data + num_pages,
+                   [this](const char *data) { return IsAligned(data); })) {
+    for (size_t i = 0; i < num_pages; ++i) {
+      WritePage(first_page_id + i, pages_data[i]);
+    }
+    return;
+  }
+
+  std::vector<struct iovec> iov(num_pages);
+  for (size_t i = 0; i < num_pages; ++i) {
+    iov[i].iov_base = const_cast<char *>(pages_data[i]);
+    iov[i].iov_len = page_size_;
+  }
+  size_t offset = PageOffset(first_page_id);
+  if (VectoredIO(true, iov.data(), num_pages, offset) <
+      num_pages * page_size_) {
+    LOG_DEBUG("I/O error while writing");
+  }
+}
+
+void DiskManager::Sync() {
+  WriteBitmaps();
+#ifdef __linux__
+  int rc = fdatasync(db_fd_);
+#else
+  int rc = fsync(db_fd_);
+#endif
+  if (rc != 0) {
+    LOG_DEBUG("I/O error while syncing");
+  }
 }
 
 /**
  * Read the contents of the specified page into the given memory area
  */
 void DiskManager::ReadPage(page_id_t page_id, char *page_data) {
-  int offset = page_id * PAGE_SIZE;
-  // check if read beyond file length
-  if (offset > GetFileSize(file_name_)) {
-    LOG_DEBUG("I/O error while reading");
-    // std::cerr << "I/O error while reading" << std::endl;
-  } else {
-    // set read cursor to offset
-    db_io_.seekp(offset);
-    db_io_.read(page_data, PAGE_SIZE);
-    // if file ends before reading PAGE_SIZE
-    int read_count = db_io_.gcount();
-    if (read_count < PAGE_SIZE) {
-      LOG_DEBUG("Read less than a page");
-      // std::cerr << "Read less than a page" << std::endl;
-      memset(page_data + read_count, 0, PAGE_SIZE - read_count);
-    }
+  size_t offset = PageOffset(page_id);
+  size_t read_count = PRead(page_data, page_size_, offset);
+  // if file ends before reading page_size_
+  if (read_count < page_size_) {
+    LOG_DEBUG("Read less than a page");
+    memset(page_data + read_count, 0, page_size_ - read_count);
+  }
+}
+
+/**
+ * Read a page through io_uring. A read that comes up short before the end of
+ * the file is finished synchronously, past the end the page is zero filled
+ * like ReadPage does. Buffers unfit for direct I/O take the synchronous path
+ */
+std::future<bool> DiskManager::ReadPageAsync(page_id_t page_id,
+                                             char *page_data, bool submit) {
+  auto promise = std::make_shared<std::promise<bool>>();
+  auto future = promise->get_future();
+  if (io_uring_ == nullptr || !IsAligned(page_data)) {
+    ReadPage(page_id, page_data);
+    promise->set_value(true);
+    return future;
+  }
+
+  size_t offset = PageOffset(page_id);
+  io_uring_->Read(db_fd_, page_data, page_size_, offset,
+                  [this, promise, page_data, offset](ssize_t res) {
+                    if (res < 0) {
+                      LOG_DEBUG("I/O error while reading");
+                      promise->set_value(false);
+                      return;
+                    }
+                    size_t read_count = res;
+                    if (read_count > 0 && read_count < page_size_) {
+                      read_count += PRead(page_data + read_count,
+                                          page_size_ - read_count,
+                                          offset + read_count);
+                    }
+                    if (read_count < page_size_) {
+                      memset(page_data + read_count, 0,
+                             page_size_ - read_count);
+                    }
+                    promise->set_value(true);
+                  });
+  if (submit) {
+    io_uring_->Submit();
+  }
+  return future;
+}
+
+/**
+ * Write a page through io_uring, a short write is finished synchronously
+ */
+std::future<bool> DiskManager::WritePageAsync(page_id_t page_id,
+                                              const char *page_data,
+                                              bool submit) {
+  auto promise = std::make_shared<std::promise<bool>>();
+  auto future = promise->get_future();
+  if (io_uring_ == nullptr || !IsAligned(page_data)) {
+    WritePage(page_id, page_data);
+    promise->set_value(true);
+    return future;
+  }
+
+  WriteBitmaps();
+  size_t offset = PageOffset(page_id);
+  io_uring_->Write(db_fd_, page_data, page_size_, offset,
+                   [this, promise, page_data, offset](ssize_t res) {
+                     size_t written = res > 0 ? res : 0;
+                     bool ok = res >= 0 &&
+                               (written == page_size_ ||
+                                PWrite(page_data + written,
+                                       page_size_ - written,
+                                       offset + written));
+                     if (!ok) {
+                       LOG_DEBUG("I/O error while writing");
+                     }
+                     promise->set_value(ok);
+                   });
+  if (submit) {
+    io_uring_->Submit();
+  }
+  return future;
+}
+
+/**
+ * Append to the log at the offset reserved for log_data, so that appends in
+ * flight together still land in the order they were issued
+ */
+std::future<bool> DiskManager::WriteLogAsync(const char *log_data, int size,
+                                             bool submit) {
+  auto promise = std::make_shared<std::promise<bool>>();
+  auto future = promise->get_future();
+  if (size <= 0) {
+    promise->set_value(true);
+    return future;
+  }
+  num_flushes_ += 1;
+  size_t offset = log_size_.fetch_add(size);
+  if (io_uring_ == nullptr) {
+    promise->set_value(WriteFully(log_fd_, log_data, size, offset));
+    return future;
+  }
+
+  io_uring_->Write(log_fd_, log_data, size, offset,
+                   [this, promise, log_data, size, offset](ssize_t res) {
+                     size_t written = res > 0 ? res : 0;
+                     bool ok = res >= 0 &&
+                               (written == static_cast<size_t>(size) ||
+                                WriteFully(log_fd_, log_data + written,
+                                           size - written, offset + written));
+                     if (!ok) {
+                       LOG_DEBUG("I/O error while writing log");
+                     }
+                     promise->set_value(ok);
+                   });
+  if (submit) {
+    io_uring_->Submit();
+  }
+  return future;
+}
+
+void DiskManager::SubmitIO() {
+  if (io_uring_ != nullptr) {
+    io_uring_->Submit();
   }
 }
 
@@ -122,6 +362,7 @@ void DiskManager::WriteLog(char *log_data, int size) {
   num_flushes_ += 1;
   // sequence write
   log_io_.write(log_data, size);
+  log_size_ += size;
 
   // check for I/O error
   if (log_io_.bad()) {
@@ -156,18 +397,124 @@ bool DiskManager::ReadLog(char *log_data, int size, int offset) {
   return true;
 }
 
+/**
+ * Map the database file read-only. Read-only buffer pools then point their
+ * frames at the mapped pages instead of copying them out of the OS page
+ * cache. return false if the file can not be mapped, or if a buffer pool
+ * that writes pages is registered: its writes would change the mapped pages
+ * under the readers
+ */
+bool DiskManager::MapFile() {
+  std::lock_guard<std::mutex> lock(map_latch_);
+  if (num_writers_ > 0 || (map_data_ == nullptr && !Remap())) {
+    return false;
+  }
+  ++num_map_users_;
+  return true;
+}
+
+/**
+ * Called by a pool that mapped the file once none of its frames points into
+ * the mapping anymore. The mapping itself stays until the destructor
+ */
+void DiskManager::UnmapFile() {
+  std::lock_guard<std::mutex> lock(map_latch_);
+  assert(num_map_users_ > 0);
+  --num_map_users_;
+}
+
+/**
+ * Register a buffer pool that writes pages. return false while a read-only
+ * pool serves pages from the mapping
+ */
+bool DiskManager::AddWriter() {
+  std::lock_guard<std::mutex> lock(map_latch_);
+  if (num_map_users_ > 0) {
+    return false;
+  }
+  ++num_writers_;
+  return true;
+}
+
+void DiskManager::RemoveWriter() {
+  std::lock_guard<std::mutex> lock(map_latch_);
+  assert(num_writers_ > 0);
+  --num_writers_;
+}
+
+/**
+ * The bytes of page_id within the mapping, nullptr if the file is not mapped
+ * or the page is past the end of the file. A page past the end of the
+ * mapping may have been written since, then the file is mapped again
+ */
+const char *DiskManager::GetMappedPage(page_id_t page_id) {
+  size_t end = PageOffset(page_id) + page_size_;
+  // the size is published after the mapping it belongs to
+  size_t map_size = map_size_.load(std::memory_order_acquire);
+  char *map_data = map_data_.load(std::memory_order_acquire);
+  if (map_data == nullptr) {
+    return nullptr;
+  }
+  if (end > map_size) {
+    std::lock_guard<std::mutex> lock(map_latch_);
+    if (end > map_size_ &&
+        (GetFileSize(file_name_) < static_cast<long long>(end) || !Remap())) {
+      return nullptr;
+    }
+    map_data = map_data_;
+  }
+  return map_data + PageOffset(page_id);
+}
+
+/**
+ * Hint the kernel how pages [first_page_id, first_page_id + num_pages) of
+ * the mapping are going to be read, num_pages = 0 for the whole file. A
+ * whole file advice carries over to later mappings
+ */
+void DiskManager::AdviseMapping(MapAdvice advice, page_id_t first_page_id,
+                                size_t num_pages) {
+  int flag = advice == MapAdvice::SEQUENTIAL ? MADV_SEQUENTIAL
+             : advice == MapAdvice::WILLNEED ? MADV_WILLNEED
+                                             : MADV_NORMAL;
+  std::lock_guard<std::mutex> lock(map_latch_);
+  if (map_data_ == nullptr) {
+    return;
+  }
+  if (num_pages == 0) {
+    map_advice_ = flag;
+    madvise(map_data_, map_size_, flag);
+    return;
+  }
+  // madvise wants the start aligned to the OS page
+  static const size_t os_page_size = sysconf(_SC_PAGESIZE);
+  size_t begin = PageOffset(first_page_id) / os_page_size * os_page_size;
+  size_t end = std::min<size_t>(
+      PageOffset(first_page_id + num_pages - 1) + page_size_, map_size_);
+  if (begin < end) {
+    madvise(map_data_ + begin, end - begin, flag);
+  }
+}
+
 /**
  * Allocate new page (operations like create index/table)
- * For now just keep an increasing counter
+ * Files without bitmaps just keep an increasing counter
+ * @input near: a page of the same table heap or index, see PageAllocator
  */
-page_id_t DiskManager::AllocatePage() { return next_page_id_++; }
+page_id_t DiskManager::AllocatePage(page_id_t near) {
+  if (allocator_ == nullptr) {
+    return next_page_id_++;
+  }
+  return allocator_->Allocate(near);
+}
 
 /**
- * Deallocate page (operations like drop index/table)
- * Need bitmap in header page for tracking pages
+ * Deallocate page (operations like drop index/table), a later AllocatePage
+ * may hand it out again. Files without bitmaps never reuse a page
  */
-void DiskManager::DeallocatePage(__attribute__((unused)) page_id_t page_id) {
-  return;
+void DiskManager::DeallocatePage(page_id_t page_id) {
+  if (allocator_ != nullptr) {
+    allocator_->Deallocate(page_id);
+  }
 }
 
 /**
@@ -183,10 +530,263 @@ bool DiskManager::GetFlushState() const { return flush_log_; }
 /**
  * Private helper function to get disk file size
  */
-int DiskManager::GetFileSize(const std::string &file_name) {
+long long DiskManager::GetFileSize(const std::string &file_name) {
   struct stat stat_buf;
   int rc = stat(file_name.c_str(), &stat_buf);
   return rc == 0 ? stat_buf.st_size : -1;
 }
 
+/**
+ * Private helper function to format a new database file: the superblock
+ * takes the first page_size_ bytes so that pages stay aligned to their size
+ */
+void DiskManager::WriteSuperblock() {
+  if (page_size_ < MIN_PAGE_SIZE || page_size_ > MAX_PAGE_SIZE ||
+      (page_size_ & (page_size_ - 1)) != 0) {
+    throw Exception(EXCEPTION_TYPE_OUT_OF_RANGE,
+                    "DiskManager: unsupported page size");
+  }
+  std::vector<char> superblock(page_size_, 0);
+  uint32_t version = SUPERBLOCK_VERSION;
+  uint32_t page_size = page_size_;
+  memcpy(&superblock[0], SUPERBLOCK_MAGIC, sizeof(SUPERBLOCK_MAGIC));
+  memcpy(&superblock[8], &version, 4);
+  memcpy(&superblock[12], &page_size, 4);
+
+  if (!PWrite(&superblock[0], page_size_, 0)) {
+    LOG_DEBUG("I/O error while writing superblock");
+    return;
+  }
+  data_offset_ = page_size_;
+  allocator_.reset(new PageAllocator(page_size_));
+}
+
+/**
+ * Private helper function to pick up the page size of an existing database
+ * file. Files written before the superblock existed hold 512 byte pages
+ * starting at offset 0
+ */
+void DiskManager::ReadSuperblock() {
+  char header[16];
+  long long file_size = GetFileSize(file_name_);
+  if (PRead(header, sizeof(header), 0) < sizeof(header) ||
+      memcmp(header, SUPERBLOCK_MAGIC, sizeof(SUPERBLOCK_MAGIC)) != 0) {
+    page_size_ = LEGACY_PAGE_SIZE;
+    data_offset_ = 0;
+    next_page_id_ = (file_size + page_size_ - 1) / page_size_;
+    return;
+  }
+
+  uint32_t version, page_size;
+  memcpy(&version, header + 8, 4);
+  memcpy(&page_size, header + 12, 4);
+  if (page_size < MIN_PAGE_SIZE || page_size > MAX_PAGE_SIZE ||
+      (page_size & (page_size - 1)) != 0 ||
+      (version != SUPERBLOCK_VERSION &&
+       version != SUPERBLOCK_VERSION_NO_BITMAPS)) {
+    throw Exception(EXCEPTION_TYPE_OUT_OF_RANGE,
+                    "DiskManager: corrupted superblock");
+  }
+  page_size_ = page_size;
+  data_offset_ = page_size_;
+  if (version == SUPERBLOCK_VERSION_NO_BITMAPS) {
+    next_page_id_ = (file_size - data_offset_ + page_size_ - 1) / page_size_;
+    return;
+  }
+
+  // every group that has started in the file has its bitmap page
+  allocator_.reset(new PageAllocator(page_size_));
+  size_t group_size = (allocator_->GetPagesPerGroup() + 1) * page_size_;
+  size_t num_groups = (file_size - data_offset_ + group_size - 1) / group_size;
+  std::vector<char> bitmap(page_size_);
+  for (size_t group = 0; group < num_groups; ++group) {
+    size_t read_count =
+        PRead(bitmap.data(), page_size_, data_offset_ + group * group_size);
+    memset(bitmap.data() + read_count, 0, page_size_ - read_count);
+    allocator_->AddGroup(bitmap.data());
+  }
+}
+
+/**
+ * Private helper function to write the bitmaps changed since the last call.
+ * Called before data pages are written. Taking and writing the changes is
+ * one step under bitmap_latch_, so a data write that finds nothing dirty
+ * knows the bitmaps it depends on have been handed to the OS. That orders
+ * the writes in the page cache only: the bitmaps are durable once Sync
+ * returns, a crash before may leave pages written since the last Sync
+ * marked free on disk. A bitmap that could not be written stays dirty and
+ * is tried again by the next call
+ */
+void DiskManager::WriteBitmaps() {
+  if (allocator_ == nullptr) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(bitmap_latch_);
+  if (!allocator_->IsDirty()) {
+    return;
+  }
+  std::vector<std::pair<size_t, std::vector<char>>> groups;
+  allocator_->TakeDirtyGroups(groups);
+  size_t group_size = (allocator_->GetPagesPerGroup() + 1) * page_size_;
+  for (auto &group : groups) {
+    if (!PWrite(group.second.data(), page_size_,
+                data_offset_ + group.first * group_size)) {
+      LOG_WARN("I/O error while writing bitmap");
+      allocator_->MarkDirty(group.first);
+    }
+  }
+}
+
+/**
+ * Private helper function to switch the db file to O_DIRECT. Pages must be a
+ * multiple of the alignment, so legacy 512 byte files stay buffered, as do
+ * files on a file system that refuses O_DIRECT
+ */
+void DiskManager::EnableDirectIO() {
+#ifdef O_DIRECT
+  if (page_size_ % DIRECT_IO_ALIGNMENT != 0 ||
+      data_offset_ % DIRECT_IO_ALIGNMENT != 0) {
+    LOG_DEBUG("page size does not allow direct I/O");
+    return;
+  }
+  int flags = fcntl(db_fd_, F_GETFL);
+  if (flags == -1 || fcntl(db_fd_, F_SETFL, flags | O_DIRECT) == -1) {
+    LOG_DEBUG("file system does not support direct I/O");
+    return;
+  }
+  direct_io_ = true;
+#endif
+}
+
+/**
+ * Private helper function to map the whole file. The previous mapping stays
+ * until the destructor, frames may still point into it
+ * should be called when holding map_latch_
+ */
+bool DiskManager::Remap() {
+  long long file_size = GetFileSize(file_name_);
+  if (db_fd_ == -1 || file_size <= 0) {
+    return false;
+  }
+  void *data = mmap(nullptr, file_size, PROT_READ, MAP_SHARED, db_fd_, 0);
+  if (data == MAP_FAILED) {
+    LOG_DEBUG("can't map db file");
+    return false;
+  }
+  madvise(data, file_size, map_advice_);
+  mappings_.emplace_back(static_cast<char *>(data), file_size);
+  map_data_.store(static_cast<char *>(data), std::memory_order_release);
+  map_size_.store(file_size, std::memory_order_release);
+  return true;
+}
+
+namespace {
+struct AlignedFree {
+  void operator()(char *p) const { free(p); }
+};
+typedef std::unique_ptr<char, AlignedFree> aligned_buffer;
+
+// a buffer fit for direct I/O, nullptr if the caller's buffer is aligned
+aligned_buffer BounceBuffer(bool aligned, size_t size) {
+  void *buffer = nullptr;
+  if (aligned || posix_memalign(&buffer, DIRECT_IO_ALIGNMENT, size) != 0) {
+    return aligned_buffer(nullptr);
+  }
+  return aligned_buffer(static_cast<char *>(buffer));
+}
+} // namespace
+
+/**
+ * Private helper function to read size bytes at offset. pread may return
+ * less than asked for when interrupted, so it is retried until the end of
+ * the file
+ */
+size_t DiskManager::PRead(char *data, size_t size, size_t offset) {
+  aligned_buffer bounce = BounceBuffer(IsAligned(data), size);
+  char *buffer = bounce ? bounce.get() : data;
+  size_t done = 0;
+  while (done < size) {
+    ssize_t rc = pread(db_fd_, buffer + done, size - done, offset + done);
+    if (rc < 0 && errno == EINTR) {
+      continue;
+    }
+    if (rc <= 0) {
+      if (rc < 0) {
+        LOG_DEBUG("I/O error while reading");
+      }
+      break;
+    }
+    done += rc;
+  }
+  if (bounce) {
+    memcpy(data, buffer, done);
+  }
+  return done;
+}
+
+/**
+ * Private helper function to write size bytes at offset of the db file
+ */
+bool DiskManager::PWrite(const char *data, size_t size, size_t offset) {
+  aligned_buffer bounce = BounceBuffer(IsAligned(data), size);
+  if (bounce) {
+    memcpy(bounce.get(), data, size);
+  }
+  return WriteFully(db_fd_, bounce ? bounce.get() : data, size, offset);
+}
+
+/**
+ * Private helper function for preadv/pwritev on the db file, retried with
+ * the rest of iov after a short transfer. iov is consumed. return the bytes
+ * transferred, fewer if a read hits the end of the file or on an error
+ */
+size_t DiskManager::VectoredIO(bool write, struct iovec *iov, size_t iovcnt,
+                               size_t offset) {
+  size_t done = 0;
+  while (iovcnt > 0) {
+    int count = static_cast<int>(std::min<size_t>(iovcnt, IOV_MAX));
+    ssize_t rc = write ? pwritev(db_fd_, iov, count, offset + done)
+                       : preadv(db_fd_, iov, count, offset + done);
+    if (rc < 0 && errno == EINTR) {
+      continue;
+    }
+    if (rc <= 0) {
+      break;
+    }
+    done += rc;
+    // skip what was transferred
+    size_t skip = rc;
+    while (iovcnt > 0 && skip >= iov->iov_len) {
+      skip -= iov->iov_len;
+      ++iov;
+      --iovcnt;
+    }
+    if (skip > 0) {
+      iov->iov_base = static_cast<char *>(iov->iov_base) + skip;
+      iov->iov_len -= skip;
+    }
+  }
+  return done;
+}
+
+/**
+ * Private helper function to write size bytes at offset of fd, retried until
+ * all of them are written
+ */
+bool DiskManager::WriteFully(int fd, const char *data, size_t size,
+                             size_t offset) {
+  size_t done = 0;
+  while (done < size) {
+    ssize_t rc = pwrite(fd, data + done, size - done, offset + done);
+    if (rc < 0 && errno == EINTR) {
+      continue;
+    }
+    if (rc <= 0) {
+      return false;
+    }
+    done += rc;
+  }
+  return true;
+}
+
 } // namespace cmudb
@@ -0,0 +1,255 @@
+/**
+ * io_uring.cpp
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "common/logger.h"
+#include "disk/io_uring.h"
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#define IO_URING_SUPPORTED
+#endif
+
+namespace cmudb {
+
+struct IoUring::Request {
+  struct iovec iov;
+  IoCallback callback;
+};
+
+#ifdef IO_URING_SUPPORTED
+
+/*
+ * Set up the ring and map its submission queue, completion queue and
+ * submission entries. On any failure the ring stays unavailable
+ */
+IoUring::IoUring(unsigned queue_depth)
+    : ring_fd_(-1), sq_entries_(0), sq_ring_(MAP_FAILED), sq_ring_size_(0),
+      cq_ring_(MAP_FAILED), cq_ring_size_(0), sqes_(MAP_FAILED),
+      sqes_size_(0), to_submit_(0), in_flight_(0) {
+  struct io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  int fd = static_cast<int>(syscall(SYS_io_uring_setup, queue_depth, &params));
+  if (fd < 0) {
+    LOG_DEBUG("io_uring is not available");
+    return;
+  }
+
+  sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  cq_ring_size_ =
+      params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+  bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+  if (single_mmap) {
+    sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+  }
+  sqes_size_ = params.sq_entries * sizeof(struct io_uring_sqe);
+  sq_ring_ = mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE,
+                  MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+  cq_ring_ = single_mmap ? sq_ring_
+                         : mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE,
+                                MAP_SHARED | MAP_POPULATE, fd,
+                                IORING_OFF_CQ_RING);
+  sqes_ = mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE,
+               MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+  if (sq_ring_ == MAP_FAILED || cq_ring_ == MAP_FAILED ||
+      sqes_ == MAP_FAILED) {
+    LOG_DEBUG("can't map io_uring");
+    if (sqes_ != MAP_FAILED)
+      munmap(sqes_, sqes_size_);
+    if (cq_ring_ != MAP_FAILED && cq_ring_ != sq_ring_)
+      munmap(cq_ring_, cq_ring_size_);
+    if (sq_ring_ != MAP_FAILED)
+      munmap(sq_ring_, sq_ring_size_);
+    close(fd);
+    return;
+  }
+
+  char *sq = static_cast<char *>(sq_ring_);
+  sq_head_ = reinterpret_cast<unsigned *>(sq + params.sq_off.head);
+  sq_tail_ = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+  sq_mask_ = reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+  sq_array_ = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+  char *cq = static_cast<char *>(cq_ring_);
+  cq_head_ = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+  cq_tail_ = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+  cq_mask_ = reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+  cqes_ = cq + params.cq_off.cqes;
+
+  ring_fd_ = fd;
+  sq_entries_ = params.sq_entries;
+  reaper_ = std::thread(&IoUring::Reap, this);
+}
+
+/*
+ * Wait for the requests in flight, then stop the completion thread with a
+ * no-op request it recognizes by its missing callback. If even that can not
+ * be submitted the thread never returns, it is left behind together with
+ * the rings it may still read
+ */
+IoUring::~IoUring() {
+  if (!IsAvailable()) {
+    return;
+  }
+  {
+    std::unique_lock<std::mutex> lock(latch_);
+    SubmitLocked();
+    cv_.wait(lock, [this] { return in_flight_ == 0; });
+    Prepare(IORING_OP_NOP, -1, 0, nullptr);
+    if (!SubmitLocked()) {
+      reaper_.detach();
+      return;
+    }
+  }
+  reaper_.join();
+  munmap(sqes_, sqes_size_);
+  if (cq_ring_ != sq_ring_)
+    munmap(cq_ring_, cq_ring_size_);
+  munmap(sq_ring_, sq_ring_size_);
+  close(ring_fd_);
+}
+
+void IoUring::Read(int fd, char *data, size_t size, size_t offset,
+                   IoCallback callback) {
+  Queue(IORING_OP_READV, fd, data, size, offset, std::move(callback));
+}
+
+void IoUring::Write(int fd, const char *data, size_t size, size_t offset,
+                    IoCallback callback) {
+  Queue(IORING_OP_WRITEV, fd, data, size, offset, std::move(callback));
+}
+
+void IoUring::Submit() {
+  std::lock_guard<std::mutex> lock(latch_);
+  SubmitLocked();
+}
+
+/*
+ * At most sq_entries_ requests are in flight. The kernel takes every queued
+ * entry on submission, so the submission ring never overflows, and the
+ * completion ring is at least twice as large
+ */
+void IoUring::Queue(unsigned char opcode, int fd, const char *data,
+                    size_t size, size_t offset, IoCallback callback) {
+  Request *request = new Request;
+  request->iov.iov_base = const_cast<char *>(data);
+  request->iov.iov_len = size;
+  request->callback = std::move(callback);
+
+  std::unique_lock<std::mutex> lock(latch_);
+  while (in_flight_ == sq_entries_) {
+    // the requests this thread queued may be what the others wait for
+    SubmitLocked();
+    cv_.wait(lock);
+  }
+  Prepare(opcode, fd, offset, request);
+}
+
+void IoUring::Prepare(unsigned char opcode, int fd, size_t offset,
+                      Request *request) {
+  unsigned tail = *sq_tail_;
+  unsigned index = tail & *sq_mask_;
+  auto sqe = static_cast<struct io_uring_sqe *>(sqes_) + index;
+  memset(sqe, 0, sizeof(*sqe));
+  sqe->opcode = opcode;
+  sqe->fd = fd;
+  sqe->off = offset;
+  if (request != nullptr) {
+    sqe->addr = reinterpret_cast<uint64_t>(&request->iov);
+    sqe->len = 1;
+  }
+  sqe->user_data = reinterpret_cast<uint64_t>(request);
+  sq_array_[index] = index;
+  // the kernel must see the entry before the new tail
+  __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+  ++to_submit_;
+  ++in_flight_;
+}
+
+/*
+ * On an error other than a transient one, the requests the kernel did not
+ * take are taken back out of the submission ring and completed with -errno,
+ * so that nobody waits for them. return false in that case
+ */
+bool IoUring::SubmitLocked() {
+  while (to_submit_ > 0) {
+    int rc = static_cast<int>(
+        syscall(SYS_io_uring_enter, ring_fd_, to_submit_, 0, 0, nullptr, 0));
+    if (rc >= 0) {
+      to_submit_ -= rc;
+      continue;
+    }
+    if (errno == EINTR || errno == EAGAIN || errno == EBUSY) {
+      std::this_thread::yield();
+      continue;
+    }
+    int error = errno;
+    LOG_DEBUG("io_uring submission failed");
+    // without SQPOLL the kernel only reads the ring inside io_uring_enter
+    unsigned tail = *sq_tail_ - to_submit_;
+    for (unsigned i = 0; i < to_submit_; ++i) {
+      auto sqe = static_cast<struct io_uring_sqe *>(sqes_) +
+                 sq_array_[(tail + i) & *sq_mask_];
+      auto request = reinterpret_cast<Request *>(sqe->user_data);
+      if (request != nullptr) {
+        request->callback(-error);
+        delete request;
+      }
+    }
+    __atomic_store_n(sq_tail_, tail, __ATOMIC_RELEASE);
+    in_flight_ -= to_submit_;
+    to_submit_ = 0;
+    cv_.notify_all();
+    return false;
+  }
+  return true;
+}
+
+void IoUring::Reap() {
+  auto cqes = static_cast<struct io_uring_cqe *>(cqes_);
+  while (true) {
+    unsigned head = *cq_head_;
+    if (head == __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE)) {
+      syscall(SYS_io_uring_enter, ring_fd_, 0, 1, IORING_ENTER_GETEVENTS,
+              nullptr, 0);
+      continue;
+    }
+    struct io_uring_cqe *cqe = cqes + (head & *cq_mask_);
+    auto request = reinterpret_cast<Request *>(cqe->user_data);
+    ssize_t res = cqe->res;
+    // the entry may be reused once the head moves past it
+    __atomic_store_n(cq_head_, head + 1, __ATOMIC_RELEASE);
+    if (request == nullptr) {
+      return;
+    }
+    request->callback(res);
+    delete request;
+    {
+      std::lock_guard<std::mutex> lock(latch_);
+      --in_flight_;
+    }
+    cv_.notify_all();
+  }
+}
+
+#else
+
+IoUring::IoUring(unsigned queue_depth) : ring_fd_(-1) {}
+IoUring::~IoUring() {}
+void IoUring::Read(int fd, char *data, size_t size, size_t offset,
+                   IoCallback callback) {}
+void IoUring::Write(int fd, const char *data, size_t size, size_t offset,
+                    IoCallback callback) {}
+void IoUring::Submit() {}
+
+#endif
+
+} // namespace cmudb
@@ -0,0 +1,176 @@
+/**
+ * page_allocator.cpp
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+#include "disk/page_allocator.h"
+
+namespace cmudb {
+
+PageAllocator::PageAllocator(size_t page_size)
+    : page_size_(page_size), pages_per_group_(page_size * 8),
+      first_free_page_(0), first_free_extent_(0), next_page_id_(0),
+      dirty_(false) {}
+
+/*
+ * Groups are added in file order, the highest allocated page decides the
+ * next page id
+ */
+void PageAllocator::AddGroup(const char *bitmap) {
+  std::lock_guard<std::mutex> lock(latch_);
+  bitmaps_.emplace_back(page_size_, 0);
+  group_dirty_.push_back(bitmap == nullptr);
+  if (bitmap == nullptr) {
+    dirty_ = true;
+    return;
+  }
+  auto &group = bitmaps_.back();
+  memcpy(group.data(), bitmap, page_size_);
+  size_t first = (bitmaps_.size() - 1) * pages_per_group_;
+  for (size_t i = page_size_; i-- > 0;) {
+    if (group[i] != 0) {
+      int bit = 7;
+      while ((group[i] & (1 << bit)) == 0) {
+        --bit;
+      }
+      next_page_id_ = static_cast<page_id_t>(first + i * 8 + bit + 1);
+      break;
+    }
+  }
+}
+
+size_t PageAllocator::GetNumGroups() {
+  std::lock_guard<std::mutex> lock(latch_);
+  return bitmaps_.size();
+}
+
+/*
+ * Near a page: a free page of its extent first, then a free extent. Else the
+ * lowest free page. When nothing fits, a new group is added at the end
+ */
+page_id_t PageAllocator::Allocate(page_id_t near) {
+  std::lock_guard<std::mutex> lock(latch_);
+  size_t byte_index;
+  int bit;
+  if (near != INVALID_PAGE_ID && near >= 0 &&
+      static_cast<size_t>(near) < bitmaps_.size() * pages_per_group_) {
+    byte_index = near / 8;
+    for (bit = 0; bit < 8; ++bit) {
+      if ((ByteAt(byte_index) & (1 << bit)) == 0) {
+        return Take(byte_index, bit);
+      }
+    }
+    if (FindFreeExtent(byte_index)) {
+      return Take(byte_index, 0);
+    }
+  }
+  if (FindFreePage(byte_index, bit)) {
+    return Take(byte_index, bit);
+  }
+
+  bitmaps_.emplace_back(page_size_, 0);
+  group_dirty_.push_back(true);
+  return Take((bitmaps_.size() - 1) * page_size_, 0);
+}
+
+bool PageAllocator::Deallocate(page_id_t page_id) {
+  std::lock_guard<std::mutex> lock(latch_);
+  if (page_id < 0 ||
+      static_cast<size_t>(page_id) >= bitmaps_.size() * pages_per_group_) {
+    return false;
+  }
+  size_t byte_index = page_id / 8;
+  unsigned char mask = static_cast<unsigned char>(1 << (page_id % 8));
+  unsigned char &byte = ByteAt(byte_index);
+  if ((byte & mask) == 0) {
+    return false;
+  }
+  byte &= static_cast<unsigned char>(~mask);
+  group_dirty_[byte_index / page_size_] = true;
+  dirty_ = true;
+  first_free_page_ = std::min(first_free_page_, byte_index);
+  if (byte == 0) {
+    first_free_extent_ = std::min(first_free_extent_, byte_index);
+  }
+  return true;
+}
+
+bool PageAllocator::IsAllocated(page_id_t page_id) {
+  std::lock_guard<std::mutex> lock(latch_);
+  if (page_id < 0 ||
+      static_cast<size_t>(page_id) >= bitmaps_.size() * pages_per_group_) {
+    return false;
+  }
+  return (ByteAt(page_id / 8) & (1 << (page_id % 8))) != 0;
+}
+
+void PageAllocator::TakeDirtyGroups(
+    std::vector<std::pair<size_t, std::vector<char>>> &groups) {
+  std::lock_guard<std::mutex> lock(latch_);
+  dirty_ = false;
+  for (size_t group = 0; group < bitmaps_.size(); ++group) {
+    if (group_dirty_[group]) {
+      groups.emplace_back(group, std::vector<char>(bitmaps_[group].begin(),
+                                                   bitmaps_[group].end()));
+      group_dirty_[group] = false;
+    }
+  }
+}
+
+void PageAllocator::MarkDirty(size_t group) {
+  std::lock_guard<std::mutex> lock(latch_);
+  assert(group < bitmaps_.size());
+  group_dirty_[group] = true;
+  dirty_ = true;
+}
+
+page_id_t PageAllocator::Take(size_t byte_index, int bit) {
+  unsigned char &byte = ByteAt(byte_index);
+  assert((byte & (1 << bit)) == 0);
+  byte |= static_cast<unsigned char>(1 << bit);
+  group_dirty_[byte_index / page_size_] = true;
+  dirty_ = true;
+  page_id_t page_id = static_cast<page_id_t>(byte_index * 8 + bit);
+  if (page_id >= next_page_id_) {
+    next_page_id_ = page_id + 1;
+  }
+  return page_id;
+}
+
+/*
+ * The scans start at the lowest byte that may qualify and remember where
+ * they stopped, so allocating a growing file stays cheap
+ */
+bool PageAllocator::FindFreeExtent(size_t &byte_index) {
+  size_t end = bitmaps_.size() * page_size_;
+  for (byte_index = first_free_extent_; byte_index < end; ++byte_index) {
+    if (ByteAt(byte_index) == 0) {
+      first_free_extent_ = byte_index;
+      return true;
+    }
+  }
+  first_free_extent_ = end;
+  return false;
+}
+
+bool PageAllocator::FindFreePage(size_t &byte_index, int &bit) {
+  size_t end = bitmaps_.size() * page_size_;
+  for (byte_index = first_free_page_; byte_index < end; ++byte_index) {
+    unsigned char byte = ByteAt(byte_index);
+    if (byte != 0xff) {
+      first_free_page_ = byte_index;
+      bit = 0;
+      while ((byte & (1 << bit)) != 0) {
+        ++bit;
+      }
+      return true;
+    }
+  }
+  first_free_page_ = end;
+  return false;
+}
+
+} // namespace cmudb
@@ -0,0 +1,182 @@
+#include <cassert>
+#include <thread>
+
+#include "common/exception.h"
+#include "hash/linear_probe_hash_table.h"
+#include "page/page.h"
+
+namespace cmudb {
+
+/*
+ * constructor
+ * capacity: largest number of entries, the table keeps load factor <= 0.5
+ */
+template <typename K, typename V>
+LinearProbeHashTable<K, V>::LinearProbeHashTable(size_t capacity)
+    : num_slots_(2), slot_bits_(1), size_(0), epoch_(0) {
+  while (num_slots_ < 2 * capacity) {
+    num_slots_ <<= 1;
+    ++slot_bits_;
+  }
+  slots_.reset(new Slot[num_slots_]);
+}
+
+/*
+ * lookup function to find value associate with input key
+ * lock free: retry a slot whose version changed while it was being read. A
+ * hit was in the table when its slot was read. A miss only holds if no
+ * writer ran meanwhile, e.g. a Remove behind the probe followed by an Insert
+ * into a tombstone the probe had already passed, otherwise probe again
+ */
+template <typename K, typename V>
+bool LinearProbeHashTable<K, V>::Find(const K &key, V &value) {
+  while (true) {
+    uint64_t epoch;
+    while ((epoch = epoch_.load(std::memory_order_acquire)) & 1) {
+      std::this_thread::yield();
+    }
+
+    size_t index = HomeSlot(key);
+    for (size_t i = 0; i < num_slots_; ++i, index = NextSlot(index)) {
+      Slot &slot = slots_[index];
+      uint32_t version;
+      uint8_t state;
+      K slot_key;
+      V slot_value;
+      do {
+        while ((version = slot.version.load(std::memory_order_acquire)) & 1) {
+          std::this_thread::yield();
+        }
+        state = slot.state.load(std::memory_order_relaxed);
+        slot_key = slot.key.load(std::memory_order_relaxed);
+        slot_value = slot.value.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+      } while (slot.version.load(std::memory_order_relaxed) != version);
+
+      if (state == EMPTY) {
+        break;
+      }
+      if (state == OCCUPIED && slot_key == key) {
+        value = slot_value;
+        return true;
+      }
+    }
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (epoch_.load(std::memory_order_relaxed) == epoch) {
+      return false;
+    }
+  }
+}
+
+/*
+ * delete <key,value> entry in hash table
+ * leave a tombstone, then clear the tombstones in front of an empty slot
+ */
+template <typename K, typename V>
+bool LinearProbeHashTable<K, V>::Remove(const K &key) {
+  std::lock_guard<std::mutex> lock(write_latch_);
+  size_t index = FindSlot(key);
+  if (index == num_slots_) {
+    return false;
+  }
+  BeginWrite();
+  WriteSlot(slots_[index], TOMBSTONE, K(), V());
+  --size_;
+
+  // no probe sequence can run through a tombstone followed by an empty slot
+  if (slots_[NextSlot(index)].state.load(std::memory_order_relaxed) == EMPTY) {
+    while (slots_[index].state.load(std::memory_order_relaxed) == TOMBSTONE) {
+      WriteSlot(slots_[index], EMPTY, K(), V());
+      index = (index - 1) & (num_slots_ - 1);
+    }
+  }
+  EndWrite();
+  return true;
+}
+
+/*
+ * insert <key,value> entry in hash table, override value if key exists
+ * reuse the first tombstone on the probe sequence when possible
+ */
+template <typename K, typename V>
+void LinearProbeHashTable<K, V>::Insert(const K &key, const V &value) {
+  std::lock_guard<std::mutex> lock(write_latch_);
+  size_t index = FindSlot(key);
+  if (index != num_slots_) {
+    WriteSlot(slots_[index], OCCUPIED, key, value);
+    return;
+  }
+
+  index = HomeSlot(key);
+  for (size_t i = 0; i < num_slots_; ++i, index = NextSlot(index)) {
+    if (slots_[index].state.load(std::memory_order_relaxed) != OCCUPIED) {
+      BeginWrite();
+      WriteSlot(slots_[index], OCCUPIED, key, value);
+      ++size_;
+      EndWrite();
+      return;
+    }
+  }
+  throw Exception(EXCEPTION_TYPE_OUT_OF_RANGE,
+                  "LinearProbeHashTable: all slots are occupied");
+}
+
+/*
+ * helper functions to make the table epoch odd while the set of keys
+ * changes, misses that overlap such a change are retried by Find
+ * should be called when holding write latch
+ */
+template <typename K, typename V>
+void LinearProbeHashTable<K, V>::BeginWrite() {
+  epoch_.store(epoch_.load(std::memory_order_relaxed) + 1,
+               std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+}
+
+template <typename K, typename V>
+void LinearProbeHashTable<K, V>::EndWrite() {
+  epoch_.store(epoch_.load(std::memory_order_relaxed) + 1,
+               std::memory_order_release);
+}
+
+/*
+ * helper function to update one slot, seqlock writer side
+ * should be called when holding write latch
+ */
+template <typename K, typename V>
+void LinearProbeHashTable<K, V>::WriteSlot(Slot &slot, SlotState state,
+                                           const K &key, const V &value) {
+  uint32_t version = slot.version.load(std::memory_order_relaxed);
+  slot.version.store(version + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  slot.state.store(state, std::memory_order_relaxed);
+  slot.key.store(key, std::memory_order_relaxed);
+  slot.value.store(value, std::memory_order_relaxed);
+  slot.version.store(version + 2, std::memory_order_release);
+}
+
+/*
+ * helper function to find the slot holding key
+ * should be called when holding write latch
+ */
+template <typename K, typename V>
+size_t LinearProbeHashTable<K, V>::FindSlot(const K &key) const {
+  size_t index = HomeSlot(key);
+  for (size_t i = 0; i < num_slots_; ++i, index = NextSlot(index)) {
+    uint8_t state = slots_[index].state.load(std::memory_order_relaxed);
+    if (state == EMPTY) {
+      break;
+    }
+    if (state == OCCUPIED &&
+        slots_[index].key.load(std::memory_order_relaxed) == key) {
+      return index;
+    }
+  }
+  return num_slots_;
+}
+
+template class LinearProbeHashTable<page_id_t, Page *>;
+// test purpose
+template class LinearProbeHashTable<int, int>;
+} // namespace cmudb
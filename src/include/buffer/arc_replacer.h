@@ -0,0 +1,87 @@
+/**
+ * arc_replacer.h
+ *
+ * Functionality: Adaptive Replacement Cache (Megiddo & Modha). Resident pages
+ * live on one of two lists: T1 holds pages accessed once since they were
+ * brought in, T2 pages accessed at least twice. Evicted pages leave their id
+ * behind on a ghost list (B1 or B2). A miss on a page found in B1 means T1 was
+ * too small, a miss found in B2 means T2 was too small, and the target size
+ * of T1 is moved accordingly. Point query bursts therefore grow the frequency
+ * side, while a full scan only ever cycles through T1 and leaves T2 alone.
+ *
+ * The buffer pool owns residency, so the replacer only learns about a miss
+ * when the new page is unpinned for the first time. Victim does not know
+ * which page is coming in and evicts from T1 whenever T1 is above target.
+ */
+
+#pragma once
+
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+#include "buffer/replacer.h"
+
+namespace cmudb {
+
+template <typename T> class ARCReplacer : public Replacer<T> {
+  typedef typename ReplacerKey<T>::type key_type;
+  enum ListId : uint8_t { RECENT = 0, FREQUENT };
+
+  struct Entry {
+    key_type key;
+    ListId list;
+    bool evictable;
+    typename std::list<T>::iterator pos;
+  };
+  struct Ghost {
+    ListId list;
+    typename std::list<key_type>::iterator pos;
+  };
+
+public:
+  // num_frames: number of frames of the buffer pool, bounds the ghost lists
+  explicit ARCReplacer(size_t num_frames);
+
+  ~ARCReplacer();
+
+  // disable copy
+  ARCReplacer(const ARCReplacer &) = delete;
+  ARCReplacer &operator=(const ARCReplacer &) = delete;
+
+  void Insert(const T &value);
+
+  bool Victim(T &value);
+
+  bool Victim(T &value, const VictimFilter<T> &filter);
+
+  bool Erase(const T &value);
+
+  size_t Size();
+
+  void SetNumFrames(size_t num_frames);
+
+  // current target size of the recency list T1 (ARC's p), in [0, num_frames]
+  size_t GetAdaptiveTarget();
+
+  // number of evicted page ids remembered on the ghost lists
+  size_t GetGhostSize();
+
+private:
+  // should be called when holding the lock
+  bool EvictFrom(ListId list, T &value, const VictimFilter<T> &filter);
+  void Forget(typename std::unordered_map<T, Entry>::iterator entry);
+  void TrimGhosts();
+
+  size_t capacity_;
+  size_t target_;    // target size of T1
+  size_t evictable_; // number of evictable entries
+  std::mutex mutex_;
+  std::list<T> lists_[2];          // T1 and T2, most recent first
+  std::list<key_type> ghosts_[2];  // B1 and B2, most recent first
+  std::unordered_map<T, Entry> entries_;
+  std::unordered_map<key_type, Ghost> ghost_index_;
+};
+
+} // namespace cmudb
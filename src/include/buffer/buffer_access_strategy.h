@@ -0,0 +1,66 @@
+/**
+ * buffer_access_strategy.h
+ *
+ * Functionality: A private ring of frames for one large sequential scan. A
+ * page the scan has to read goes into the oldest frame of its ring instead
+ * of a frame taken from the shared replacer, so the scan cycles through a
+ * few frames and leaves the rest of the pool (and its working set) alone.
+ * Pages the scan finds resident are used in place and stay shared.
+ *
+ * Frames of a ring are never handed to the replacer while the ring holds
+ * them. A frame whose page is pinned by someone else or whose log records
+ * are not persistent yet is not recycled, the scan falls back to a regular
+ * victim and the ring moves on to that one. When the strategy goes away its
+ * frames are given back to the replacer with their pages still cached.
+ *
+ * Strategies are created by BufferPoolManager::GetAccessStrategy and must not
+ * outlive it. The ring is split over the shards, each shard only touches its
+ * own part under its own latch.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "page/page.h"
+
+namespace cmudb {
+
+class BufferPoolManager;
+
+// frames one buffer pool instance lends to a strategy
+struct FrameRing {
+  explicit FrameRing(size_t capacity) : capacity(capacity) {}
+
+  size_t capacity;           // max number of frames
+  size_t next = 0;           // oldest frame once the ring is full
+  std::vector<Page *> frames;
+};
+
+class BufferAccessStrategy {
+public:
+  BufferAccessStrategy(BufferPoolManager *buffer_pool_manager,
+                       size_t num_instances, size_t ring_size);
+
+  // give the frames back to the buffer pool
+  ~BufferAccessStrategy();
+
+  // disable copy
+  BufferAccessStrategy(const BufferAccessStrategy &) = delete;
+  BufferAccessStrategy &operator=(const BufferAccessStrategy &) = delete;
+
+  // number of frames of the ring over all shards
+  inline size_t GetRingSize() const { return ring_size_; }
+
+  // part of the ring in the shard with the given index
+  inline FrameRing *GetRing(size_t instance_index) {
+    return &rings_[instance_index];
+  }
+
+private:
+  BufferPoolManager *buffer_pool_manager_;
+  size_t ring_size_;
+  std::vector<FrameRing> rings_;
+};
+
+} // namespace cmudb
@@ -4,25 +4,78 @@
  * Functionality: The simplified Buffer Manager interface allows a client to
  * new/delete pages on disk, to read a disk page into the buffer pool and pin
  * it, also to unpin a page in the buffer pool.
+ *
+ * The pool is partitioned into several BufferPoolManagerInstance shards, and
+ * a page id always hashes to the same shard. Each shard has its own latch, so
+ * operations on pages living in different shards run in parallel.
+ *
+ * An optional background page cleaner wakes up periodically and writes back
+ * dirty unpinned pages, so that foreground fetches find clean victims and do
+ * not pay for the write.
+ *
+ * Prefetch queues pages for a read-ahead thread, which loads them while a
+ * sequential scan is still busy with the pages before.
+ *
+ * The guarded fetches return page guards, which unlatch and unpin the page
+ * they hold when they go out of scope.
+ *
+ * With a compressed cache size, every shard keeps its share of evicted pages
+ * compressed in memory and looks there before reading a missing page.
+ *
+ * A large sequential scan can read through a BufferAccessStrategy, which
+ * keeps the pages it brings in within a small ring of frames.
+ *
+ * DumpPages saves the ids of the resident pages, most recently used first,
+ * to a side file, either on demand (e.g. at a clean shutdown) or
+ * periodically from a dumper thread. LoadPages reads them back after a
+ * restart and queues the hottest pool size of them for read-ahead in page id
+ * order. Warm-up reads only fill free frames, they never evict a page that
+ * was fetched meanwhile.
+ *
+ * Resize adds or retires frames on every shard without stopping the threads
+ * that use the pool.
+ *
+ * FlushAllPages writes the dirty pages of all shards in page id order, one
+ * write per run of consecutive pages, followed by a single sync.
+ *
+ * A read-only pool (e.g. for a reporting session) can not create or delete
+ * pages. It maps the database file and serves misses from the mapping
+ * without copying the page, scans advise the kernel to read ahead
+ * sequentially and Prefetch becomes a WILLNEED hint. A mapped page would
+ * change under its readers if a regular pool wrote it, so the file is only
+ * mapped while no regular pool uses the disk manager, otherwise the
+ * read-only pool copies pages into its frames. Creating a regular pool while
+ * a read-only one maps the file throws.
  */
 
 #pragma once
 
-#include <list>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
 #include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
 
-#include "buffer/lru_replacer.h"
-#include "disk/disk_manager.h"
-#include "hash/extendible_hash.h"
-#include "logging/log_manager.h"
-#include "page/page.h"
+#include "buffer/buffer_access_strategy.h"
+#include "buffer/buffer_pool_manager_instance.h"
+#include "buffer/page_guard.h"
 
 namespace cmudb {
 
 class BufferPoolManager {
+  friend class BufferAccessStrategy;
+
 public:
   BufferPoolManager(size_t pool_size, DiskManager *disk_manager,
-                    LogManager *log_manager = nullptr);
+                    LogManager *log_manager = nullptr,
+                    size_t num_instances = 1,
+                    ReplacerPolicy policy = ReplacerPolicy::LRU,
+                    size_t compressed_cache_size = 0,
+                    bool read_only = false);
 
   ~BufferPoolManager();
 
@@ -30,37 +83,167 @@ public:
   BufferPoolManager(BufferPoolManager const &) = delete;
   BufferPoolManager &operator=(BufferPoolManager const &) = delete;
 
-  Page *FetchPage(page_id_t page_id);
+  // a miss goes into the ring of strategy if there is one
+  Page *FetchPage(page_id_t page_id, BufferAccessStrategy *strategy = nullptr);
 
   bool UnpinPage(page_id_t page_id, bool is_dirty);
 
   bool FlushPage(page_id_t page_id);
 
-  Page *NewPage(page_id_t &page_id);
+  // near: a page of the same table heap or index, the new page is placed
+  // close to it on disk (see DiskManager::AllocatePage)
+  Page *NewPage(page_id_t &page_id, page_id_t near = INVALID_PAGE_ID);
 
   bool DeletePage(page_id_t page_id);
 
+  // same as FetchPage/NewPage, but the pin (and latch) is owned by the
+  // returned guard. an empty guard means all the pages are pinned
+  PageGuard FetchPageGuarded(page_id_t page_id);
+  ReadPageGuard FetchPageRead(page_id_t page_id,
+                              BufferAccessStrategy *strategy = nullptr);
+  WritePageGuard FetchPageWrite(page_id_t page_id);
+  PageGuard NewPageGuarded(page_id_t &page_id,
+                           page_id_t near = INVALID_PAGE_ID);
+
+  // write back every dirty page, return number of pages written
+  size_t FlushAllPages();
+
+  // grow or shrink the pool to pool_size frames while it is in use, return
+  // the number of frames it has now. pinned frames stay, so a shrink may
+  // fall short and can be repeated once they are unpinned
+  size_t Resize(size_t pool_size);
+
+  // asynchronously read pages [page_id, page_id + count) into the pool, or
+  // into the ring of strategy
+  void Prefetch(page_id_t page_id, size_t count = 1,
+                std::shared_ptr<BufferAccessStrategy> strategy = nullptr);
+
+  // save the ids of the resident pages to file_name, return their number
+  size_t DumpPages(const std::string &file_name);
+  // queue the pages saved in file_name for read-ahead, return the number of
+  // pages queued
+  size_t LoadPages(const std::string &file_name);
+
+  // spawn a separate thread to dump the resident pages every interval
+  void RunPageDumper(const std::string &file_name,
+                     std::chrono::milliseconds interval = PAGE_DUMP_INTERVAL);
+  void StopPageDumper();
+
+  // a ring of about ring_size frames for a sequential scan, nullptr if the
+  // pool is too small for one. the strategy must not outlive the buffer pool
+  std::shared_ptr<BufferAccessStrategy>
+  GetAccessStrategy(size_t ring_size = SCAN_RING_SIZE);
+
+  // spawn a separate thread to write back dirty pages in the background
+  void RunPageCleaner();
+  void StopPageCleaner();
+
+  // page cleaner tunables, may be changed while the cleaner runs
+  // number of clean evictable frames the cleaner keeps, over all shards
+  inline void SetCleanerTarget(size_t target) { cleaner_target_ = target; }
+  // max number of pages a cleaner round writes per shard
+  inline void SetCleanerBatchSize(size_t batch_size) {
+    cleaner_batch_size_ = batch_size;
+  }
+  // time between two cleaner rounds
+  void SetCleanerInterval(std::chrono::milliseconds interval);
+
+  inline size_t GetPoolSize() const { return pool_size_; }
+  inline size_t GetPageSize() const { return disk_manager_->GetPageSize(); }
+  inline size_t GetNumInstances() const { return instances_.size(); }
+  inline bool IsReadOnly() const { return read_only_; }
+  // whether misses are served from the file mapping
+  inline bool IsMapped() const { return mapped_reads_; }
+
+  // counters of all shards added up
+  BufferPoolStats GetStats() const {
+    BufferPoolStats stats;
+    for (auto &instance : instances_) {
+      stats += instance->GetStats();
+    }
+    return stats;
+  }
+
   // for debug
   bool Check() const {
-    //std::cerr << "table: " << page_table_->Size() << " replacer: "
-    //          << replacer_->Size() << std::endl;
+    size_t table_size = 0, replacer_size = 0;
+    for (auto &instance : instances_) {
+      table_size += instance->GetPageTableSize();
+      replacer_size += instance->GetReplacerSize();
+    }
     // +1 for header_page, in the test environment,
     // header_page is out the replacer's control
-    return page_table_->Size() == (replacer_->Size() + 1);
+    return table_size == (replacer_size + 1);
   }
 
 private:
-  size_t pool_size_;                         // number of pages in buffer pool
-  Page *pages_;                              // array of pages
-  DiskManager *disk_manager_;
-  LogManager *log_manager_;
+  // the shard responsible for page_id
+  inline size_t GetInstanceIndex(page_id_t page_id) const {
+    return static_cast<size_t>(page_id) % instances_.size();
+  }
+  inline BufferPoolManagerInstance *GetInstance(page_id_t page_id) {
+    return instances_[GetInstanceIndex(page_id)].get();
+  }
+  // the part of the ring of strategy in the shard responsible for page_id
+  inline FrameRing *GetRing(BufferAccessStrategy *strategy,
+                            page_id_t page_id) {
+    return strategy == nullptr ? nullptr
+                               : strategy->GetRing(GetInstanceIndex(page_id));
+  }
 
-  HashTable<page_id_t, Page *> *page_table_; // to keep track of pages that are currently in memory
+  // called by the destructor of strategy
+  void ReleaseStrategy(BufferAccessStrategy *strategy);
 
-  Replacer<Page *> *replacer_;               // to find an unpinned page for replacement
-  std::list<Page *> *free_list_;             // to find a free page for replacement
+  // body of the page dumper thread
+  void PageDumper();
 
-  std::mutex latch_;                         // to protect shared data structure
+  // body of the page cleaner thread
+  void PageCleaner();
+  // should be called when holding prefetch_latch_
+  void StartPrefetcher();
+  // body of the read-ahead thread
+  void Prefetcher();
+  // bring in the pages of batch, runs of adjacent pages with one read
+  struct PrefetchRequest;
+  void ReadAhead(const std::vector<PrefetchRequest> &batch);
+
+  std::atomic<size_t> pool_size_;            // number of pages in all shards
+  DiskManager *disk_manager_;
+  bool read_only_;
+  bool mapped_reads_;
+  std::atomic<size_t> active_scans_;         // strategies of a mapped pool
+  std::vector<std::unique_ptr<BufferPoolManagerInstance>> instances_;
+  std::mutex flush_latch_;                   // one FlushAllPages at a time
+  std::mutex resize_latch_;                  // one Resize at a time
+
+  // page cleaner
+  std::atomic<size_t> cleaner_target_;
+  std::atomic<size_t> cleaner_batch_size_;
+  std::chrono::milliseconds cleaner_interval_;
+  bool cleaner_running_;
+  std::mutex cleaner_latch_;                 // to protect cleaner state
+  std::condition_variable cleaner_cv_;       // for notifying cleaner thread
+  std::thread cleaner_thread_;
+
+  // page dumper
+  std::string dump_file_name_;
+  std::chrono::milliseconds dump_interval_;
+  bool dumper_running_;
+  std::mutex dumper_latch_;                  // to protect dumper state
+  std::condition_variable dumper_cv_;        // for notifying dumper thread
+  std::thread dumper_thread_;
+
+  // read-ahead, the thread is started by the first Prefetch
+  struct PrefetchRequest {
+    page_id_t page_id;
+    std::shared_ptr<BufferAccessStrategy> strategy;
+    bool warm_up;                            // only fill free frames
+  };
+  std::deque<PrefetchRequest> prefetch_queue_;
+  bool prefetch_running_;
+  std::mutex prefetch_latch_;                // to protect read-ahead state
+  std::condition_variable prefetch_cv_;      // for notifying read-ahead thread
+  std::thread prefetch_thread_;
 };
 
 } // namespace cmudb
@@ -0,0 +1,167 @@
+/*
+ * buffer_pool_manager_instance.h
+ *
+ * Functionality: One shard of the buffer pool. Each instance owns its own
+ * frames, free list, page table, replacer and latch, so threads working on
+ * pages that hash to different instances never contend with each other.
+ * Clients should go through BufferPoolManager, which routes every call to the
+ * instance responsible for the page id.
+ *
+ * Disk I/O never happens under the instance latch. A frame that is being
+ * filled is pinned and flagged io in progress, so only fetchers of that page
+ * wait for it (on io_cv_) while hits on other pages go ahead.
+ *
+ * When logging is enabled, eviction prefers clean frames and dirty frames
+ * whose log records are already persistent. Only if there is none does the
+ * writeback of the victim wait for the log flush, after the latch is dropped.
+ *
+ * With a compressed cache, a victim is compressed into it once it is clean
+ * (again outside the latch, fetchers of the victim wait as for a writeback)
+ * and a miss is served from there if the page is found.
+ *
+ * A fetch or prefetch may come with the ring of an access strategy, then a
+ * miss recycles the oldest frame of the ring rather than asking the
+ * replacer, see buffer_access_strategy.h.
+ *
+ * With mapped reads (a read-only pool) a miss does not copy the page into
+ * the frame, the frame points into the read-only file mapping of the disk
+ * manager instead, so the page exists once in memory, in the OS page cache.
+ *
+ * Resize adds frames (up to BUFFER_POOL_MAX_GROWTH times the initial size)
+ * or retires unpinned ones while other threads keep using the instance.
+ * Pinned frames are never taken away, a shrink retires what it can.
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <list>
+#include <mutex>
+#include <unordered_set>
+#include <vector>
+
+#include "buffer/arc_replacer.h"
+#include "buffer/buffer_access_strategy.h"
+#include "buffer/buffer_pool_stats.h"
+#include "buffer/clock_replacer.h"
+#include "buffer/compressed_cache.h"
+#include "buffer/frame_arena.h"
+#include "buffer/lru_k_replacer.h"
+#include "buffer/lru_replacer.h"
+#include "disk/disk_manager.h"
+#include "hash/linear_probe_hash_table.h"
+#include "logging/log_manager.h"
+#include "page/page.h"
+
+namespace cmudb {
+
+class BufferPoolManagerInstance {
+public:
+  BufferPoolManagerInstance(size_t pool_size, DiskManager *disk_manager,
+                            LogManager *log_manager = nullptr,
+                            ReplacerPolicy policy = ReplacerPolicy::LRU,
+                            size_t compressed_cache_size = 0,
+                            bool mapped_reads = false);
+
+  ~BufferPoolManagerInstance();
+
+  // disable copy
+  BufferPoolManagerInstance(BufferPoolManagerInstance const &) = delete;
+  BufferPoolManagerInstance &
+  operator=(BufferPoolManagerInstance const &) = delete;
+
+  // a miss loads the page into ring if ring is not nullptr
+  Page *FetchPage(page_id_t page_id, FrameRing *ring = nullptr);
+
+  bool UnpinPage(page_id_t page_id, bool is_dirty);
+
+  bool FlushPage(page_id_t page_id);
+
+  // page_id has already been allocated by the caller
+  Page *NewPage(page_id_t page_id);
+
+  bool DeletePage(page_id_t page_id);
+
+  // read-ahead in two steps, so that the reads of adjacent pages can be
+  // issued together. BeginPrefetch brings page_id into a frame unless it is
+  // resident already and returns false if it does not. frame is the frame
+  // the caller reads the page into before EndPrefetch, nullptr if the page
+  // is complete already. the page is left unpinned
+  // free_frames_only: do not evict anything for the page
+  bool BeginPrefetch(page_id_t page_id, FrameRing *ring,
+                     bool free_frames_only, Page *&frame);
+  void EndPrefetch(Page *frame);
+
+  // append the ids of the resident pages, most recently fetched first
+  void GetResidentPages(std::vector<page_id_t> &page_ids);
+
+  // hand the frames of ring back to the replacer
+  void ReleaseRing(FrameRing *ring);
+
+  // write back up to max_pages dirty unpinned pages, in page id order, until
+  // target frames are clean and evictable. return number of pages written
+  size_t CleanPages(size_t max_pages, size_t target);
+
+  // copy every dirty page into buffer, append its id to page_ids and mark it
+  // clean. the pages stay write protected until EndFlush
+  void BeginFlush(std::vector<page_id_t> &page_ids, std::vector<char> &buffer);
+  void EndFlush(const std::vector<page_id_t> &page_ids);
+
+  // grow or shrink to pool_size frames, return the number of frames now
+  size_t Resize(size_t pool_size);
+
+  // snapshot of the counters
+  inline BufferPoolStats GetStats() const { return counters_.Snapshot(); }
+
+  // for debug
+  size_t GetPageTableSize() const { return page_table_->Size(); }
+  size_t GetReplacerSize() const { return replacer_->Size(); }
+
+private:
+  // acquire the latch, time the wait only if it is contended
+  std::unique_lock<std::mutex> AcquireLatch();
+
+  // should be called when holding the latch, return with the latch held
+  Page *LoadFrame(std::unique_lock<std::mutex> &lock, page_id_t page_id,
+                  bool read_from_disk, FrameRing *ring = nullptr,
+                  bool defer_read = false);
+  bool RetireFrame(std::unique_lock<std::mutex> &lock);
+  void DropFrame(Page *frame);
+
+  // should be called when holding the latch
+  bool PickVictim(Page *&victim);
+  bool PickRingFrame(FrameRing *ring, Page *&frame);
+  void AddToRing(FrameRing *ring, Page *frame);
+  void RemoveFromRing(FrameRing *ring, Page *frame);
+  // whether frame points into the file mapping rather than its own memory
+  inline bool IsMapped(const Page *frame) const {
+    return frame->data_ != arena_->GetFrameData(frame);
+  }
+  // should be called without the latch, old_page_id is in writeback_
+  void WriteBack(Page *frame, page_id_t old_page_id, bool write_back,
+                 bool keep);
+
+  size_t pool_size_;                         // number of pages in buffer pool
+  size_t page_size_;                         // size of a page in byte
+  FrameArena *arena_;                        // memory of all frames
+  Page *pages_;                              // array of pages
+  DiskManager *disk_manager_;
+  LogManager *log_manager_;
+
+  HashTable<page_id_t, Page *> *page_table_; // to keep track of pages that are currently in memory
+
+  Replacer<Page *> *replacer_;               // to find an unpinned page for replacement
+  std::list<Page *> *free_list_;             // to find a free page for replacement
+  CompressedCache *compressed_cache_;        // evicted pages, nullptr if none
+  bool mapped_reads_;                        // serve misses from the mapping
+
+  std::mutex latch_;                         // to protect shared data structure
+  std::condition_variable io_cv_;            // signaled when a frame finishes io
+  std::unordered_set<page_id_t> writeback_;  // evicted pages not yet on disk
+  std::unordered_set<page_id_t> cleaning_;   // pages being written by cleaner
+  std::vector<Page *> retired_;              // frames given up by Resize
+  uint64_t access_clock_;                    // ticks on every fetch
+  BufferPoolCounters counters_;
+};
+
+} // namespace cmudb
@@ -0,0 +1,152 @@
+/**
+ * buffer_pool_stats.h
+ *
+ * Functionality: Counters kept by every buffer pool instance. Updating a
+ * counter is a relaxed atomic increment on memory the instance already owns,
+ * and the latch wait is only timed when the latch is contended, so the
+ * counters are always on. BufferPoolManager::GetStats adds up a snapshot of
+ * every instance.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace cmudb {
+
+// pin count histogram buckets: 1, 2, 3-4, 5-8, ..., >= 2^(N-2)+1
+#define PIN_COUNT_BUCKETS 8
+
+/*
+ * Plain snapshot of the counters
+ */
+struct BufferPoolStats {
+  uint64_t fetch_hits = 0;         // FetchPage found the page resident
+  uint64_t fetch_misses = 0;       // FetchPage had to read the page
+  uint64_t new_pages = 0;          // successful NewPage calls
+  uint64_t evictions = 0;          // frames taken from the replacer
+  uint64_t writebacks = 0;         // dirty victims written by a foreground call
+  uint64_t cleaner_writebacks = 0; // dirty pages written by the page cleaner
+  uint64_t prefetches = 0;         // pages read by read-ahead
+  uint64_t ring_reuses = 0;        // frames recycled within a strategy ring
+  uint64_t wal_waits = 0;          // writebacks that waited for the log
+  uint64_t latch_waits = 0;        // contended acquisitions of the latch
+  uint64_t latch_wait_ns = 0;      // time spent waiting for the latch
+  uint64_t tier2_hits = 0;         // misses served by the compressed cache
+  uint64_t tier2_misses = 0;       // misses the compressed cache did not serve
+  uint64_t tier2_bytes_in = 0;     // page bytes put into the compressed cache
+  uint64_t tier2_bytes_out = 0;    // compressed bytes they took there
+  uint64_t mapped_reads = 0;       // misses served from the file mapping
+  // pin count of a page right after FetchPage pinned it
+  uint64_t pin_count_histogram[PIN_COUNT_BUCKETS] = {};
+
+  inline double GetHitRatio() const {
+    uint64_t fetches = fetch_hits + fetch_misses;
+    return fetches == 0 ? 0 : static_cast<double>(fetch_hits) / fetches;
+  }
+
+  inline double GetTier2HitRatio() const {
+    uint64_t lookups = tier2_hits + tier2_misses;
+    return lookups == 0 ? 0 : static_cast<double>(tier2_hits) / lookups;
+  }
+
+  // page bytes per byte held by the compressed cache
+  inline double GetCompressionRatio() const {
+    return tier2_bytes_out == 0
+               ? 0
+               : static_cast<double>(tier2_bytes_in) / tier2_bytes_out;
+  }
+
+  BufferPoolStats &operator+=(const BufferPoolStats &other) {
+    fetch_hits += other.fetch_hits;
+    fetch_misses += other.fetch_misses;
+    new_pages += other.new_pages;
+    evictions += other.evictions;
+    writebacks += other.writebacks;
+    cleaner_writebacks += other.cleaner_writebacks;
+    prefetches += other.prefetches;
+    ring_reuses += other.ring_reuses;
+    wal_waits += other.wal_waits;
+    latch_waits += other.latch_waits;
+    latch_wait_ns += other.latch_wait_ns;
+    tier2_hits += other.tier2_hits;
+    tier2_misses += other.tier2_misses;
+    tier2_bytes_in += other.tier2_bytes_in;
+    tier2_bytes_out += other.tier2_bytes_out;
+    mapped_reads += other.mapped_reads;
+    for (int i = 0; i < PIN_COUNT_BUCKETS; ++i) {
+      pin_count_histogram[i] += other.pin_count_histogram[i];
+    }
+    return *this;
+  }
+};
+
+/*
+ * Live counters of one buffer pool instance
+ */
+class BufferPoolCounters {
+  typedef std::atomic<uint64_t> counter_type;
+
+public:
+  counter_type fetch_hits{0};
+  counter_type fetch_misses{0};
+  counter_type new_pages{0};
+  counter_type evictions{0};
+  counter_type writebacks{0};
+  counter_type cleaner_writebacks{0};
+  counter_type prefetches{0};
+  counter_type ring_reuses{0};
+  counter_type wal_waits{0};
+  counter_type latch_waits{0};
+  counter_type latch_wait_ns{0};
+  counter_type tier2_hits{0};
+  counter_type tier2_misses{0};
+  counter_type tier2_bytes_in{0};
+  counter_type tier2_bytes_out{0};
+  counter_type mapped_reads{0};
+  counter_type pin_count_histogram[PIN_COUNT_BUCKETS] = {};
+
+  static inline void Add(counter_type &counter, uint64_t value = 1) {
+    counter.fetch_add(value, std::memory_order_relaxed);
+  }
+
+  inline void AddPinCount(int pin_count) {
+    int bucket = 0;
+    while (bucket < PIN_COUNT_BUCKETS - 1 && (1 << bucket) < pin_count) {
+      ++bucket;
+    }
+    Add(pin_count_histogram[bucket]);
+  }
+
+  BufferPoolStats Snapshot() const {
+    BufferPoolStats stats;
+    stats.fetch_hits = Load(fetch_hits);
+    stats.fetch_misses = Load(fetch_misses);
+    stats.new_pages = Load(new_pages);
+    stats.evictions = Load(evictions);
+    stats.writebacks = Load(writebacks);
+    stats.cleaner_writebacks = Load(cleaner_writebacks);
+    stats.prefetches = Load(prefetches);
+    stats.ring_reuses = Load(ring_reuses);
+    stats.wal_waits = Load(wal_waits);
+    stats.latch_waits = Load(latch_waits);
+    stats.latch_wait_ns = Load(latch_wait_ns);
+    stats.tier2_hits = Load(tier2_hits);
+    stats.tier2_misses = Load(tier2_misses);
+    stats.tier2_bytes_in = Load(tier2_bytes_in);
+    stats.tier2_bytes_out = Load(tier2_bytes_out);
+    stats.mapped_reads = Load(mapped_reads);
+    for (int i = 0; i < PIN_COUNT_BUCKETS; ++i) {
+      stats.pin_count_histogram[i] = Load(pin_count_histogram[i]);
+    }
+    return stats;
+  }
+
+private:
+  static inline uint64_t Load(const counter_type &counter) {
+    return counter.load(std::memory_order_relaxed);
+  }
+};
+
+} // namespace cmudb
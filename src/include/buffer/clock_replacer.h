@@ -0,0 +1,62 @@
+/**
+ * clock_replacer.h
+ *
+ * Functionality: CLOCK (second chance) approximation of LRU. Every frame owns
+ * one byte in a flat array indexed by frame id, holding an "evictable" bit
+ * and a "referenced" bit. Insert (unpin) and Erase (pin) are a single atomic
+ * store/exchange on that byte: no allocation, no lookup structure and no
+ * lock. Victim sweeps a clock hand over the array, clearing referenced bits
+ * until it finds an evictable frame that was not referenced since the hand
+ * last passed it.
+ *
+ * Values are mapped to frame ids by their distance from a base value, so
+ * the replacer works for both frame pointers (base = first frame) and plain
+ * frame numbers (base = 0).
+ */
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+
+#include "buffer/replacer.h"
+
+namespace cmudb {
+
+template <typename T> class ClockReplacer : public Replacer<T> {
+  enum FrameState : uint8_t { EVICTABLE = 1, REFERENCED = 2 };
+
+public:
+  // value of frame i is base + i
+  explicit ClockReplacer(size_t num_frames, T base = T());
+
+  ~ClockReplacer();
+
+  // disable copy
+  ClockReplacer(const ClockReplacer &) = delete;
+  ClockReplacer &operator=(const ClockReplacer &) = delete;
+
+  void Insert(const T &value);
+
+  bool Victim(T &value);
+
+  bool Victim(T &value, const VictimFilter<T> &filter);
+
+  bool Erase(const T &value);
+
+  size_t Size();
+
+private:
+  inline size_t FrameId(const T &value) const {
+    return static_cast<size_t>(value - base_);
+  }
+
+  const size_t num_frames_;
+  const T base_;
+  std::unique_ptr<std::atomic<uint8_t>[]> frames_;
+  std::mutex hand_latch_; // only victim selection moves the hand
+  size_t hand_;
+};
+
+} // namespace cmudb
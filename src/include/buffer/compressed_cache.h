@@ -0,0 +1,73 @@
+/**
+ * compressed_cache.h
+ *
+ * Functionality: Second tier below the buffer pool. Pages evicted from a
+ * buffer pool instance are kept here compressed, so a later miss on them
+ * costs a decompression instead of a disk read. Once a page is back in a
+ * frame its copy is dropped, the two tiers never hold the same page.
+ *
+ * The cache is bounded by the bytes of compressed data it holds and evicts
+ * the least recently inserted pages first. Pages are compressed with a
+ * small LZ77 style codec (no external dependency) and stored as they are
+ * when they do not compress.
+ */
+
+#pragma once
+
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "common/config.h"
+
+namespace cmudb {
+
+class CompressedCache {
+public:
+  CompressedCache(size_t capacity, size_t page_size);
+
+  // disable copy
+  CompressedCache(const CompressedCache &) = delete;
+  CompressedCache &operator=(const CompressedCache &) = delete;
+
+  // keep a copy of page_data, replacing an older copy of page_id. return
+  // the number of bytes stored, 0 if the page did not fit
+  size_t Insert(page_id_t page_id, const char *page_data);
+
+  // copy page_id into page_data and drop it. return false if not cached
+  bool Take(page_id_t page_id, char *page_data);
+
+  // drop page_id if it is cached
+  void Erase(page_id_t page_id);
+
+  size_t Size();
+  size_t GetBytes();
+
+  // codec, dst must have room for MaxCompressedSize(size) bytes
+  static size_t MaxCompressedSize(size_t size);
+  static size_t Compress(const char *src, size_t size, char *dst);
+  // return false if src is corrupted or does not fill dst_size bytes
+  static bool Decompress(const char *src, size_t size, char *dst,
+                         size_t dst_size);
+
+private:
+  struct Entry {
+    page_id_t page_id;
+    bool raw;               // stored uncompressed
+    std::vector<char> data;
+  };
+  typedef std::list<Entry>::iterator iterator_type;
+
+  // should be called when holding the latch
+  void Remove(iterator_type it);
+
+  size_t capacity_;       // max bytes of page data held
+  size_t page_size_;
+  size_t bytes_;          // bytes of page data held
+  std::list<Entry> lru_;  // most recently inserted first
+  std::unordered_map<page_id_t, iterator_type> index_;
+  std::mutex latch_;
+};
+
+} // namespace cmudb
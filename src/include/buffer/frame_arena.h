@@ -0,0 +1,73 @@
+/**
+ * frame_arena.h
+ *
+ * Functionality: Memory of a buffer pool instance. The page bytes of all
+ * frames live in one anonymous mapping, aligned to the OS page and
+ * optionally backed by huge pages, which keeps TLB misses down when the pool
+ * is large. The frame descriptors (Page objects with pin count, dirty flag,
+ * latch...) are kept in a separate array. Every descriptor is padded to a
+ * cache line boundary, so threads pinning neighbouring frames do not
+ * invalidate each other's cache lines.
+ *
+ * Address space is reserved for max_frames frames up front, so an arena can
+ * grow in place and frames never move. Memory is only committed when a frame
+ * is first used, and handed back to the OS when a frame is released. Huge
+ * pages are the exception: they are committed when a frame is added, so
+ * that running out of them stops the arena from growing rather than
+ * faulting later.
+ */
+
+#pragma once
+
+#include <cstddef>
+
+#include "page/page.h"
+
+namespace cmudb {
+
+class FrameArena {
+public:
+  // use_huge_pages: try explicit huge pages first, then transparent ones
+  // max_frames: number of frames the arena can grow to, at least num_frames
+  FrameArena(size_t num_frames, size_t page_size, bool use_huge_pages = false,
+             size_t max_frames = 0);
+
+  ~FrameArena();
+
+  // disable copy
+  FrameArena(const FrameArena &) = delete;
+  FrameArena &operator=(const FrameArena &) = delete;
+
+  // descriptors of all frames, with their data already attached
+  inline Page *GetFrames() { return frames_; }
+  inline size_t GetNumFrames() const { return num_frames_; }
+  inline size_t GetMaxFrames() const { return max_frames_; }
+
+  // append a frame, return nullptr if max_frames are in use already or no
+  // huge page is left to back it
+  Page *AddFrame();
+
+  // give the page bytes of an unused frame back to the OS, they read as
+  // zeros when the frame is used again
+  void ReleaseFrame(Page *frame);
+
+  // the page bytes of frame, also while its data points elsewhere (a page
+  // served from the file mapping)
+  inline char *GetFrameData(const Page *frame) const {
+    return data_ + (frame - frames_) * page_size_;
+  }
+
+  // true if the page bytes are mapped with MAP_HUGETLB
+  inline bool IsHugeTLB() const { return huge_tlb_; }
+
+private:
+  size_t num_frames_;
+  size_t max_frames_;
+  size_t page_size_;
+  size_t mapping_size_; // bytes mapped for page data
+  bool huge_tlb_;
+  char *data_;          // page bytes of all frames
+  Page *frames_;        // frame descriptors
+};
+
+} // namespace cmudb
@@ -0,0 +1,69 @@
+/**
+ * lru_k_replacer.h
+ *
+ * Functionality: LRU-K replacement. The replacer remembers the timestamps of
+ * the last K accesses (unpins) of every page and evicts the page whose K-th
+ * most recent access lies furthest in the past. Pages with fewer than K
+ * accesses have an infinite backward K-distance and go first, oldest access
+ * first. A page touched once by a sequential scan is therefore evicted before
+ * a B+ tree internal page that is used over and over, where plain LRU would
+ * throw the internal page out.
+ *
+ * Access history is kept per page (see ReplacerKey) for as long as the page
+ * is resident and dropped when the page is chosen as a victim.
+ */
+
+#pragma once
+
+#include <deque>
+#include <mutex>
+#include <set>
+#include <unordered_map>
+#include <utility>
+
+#include "buffer/replacer.h"
+
+namespace cmudb {
+
+template <typename T> class LRUKReplacer : public Replacer<T> {
+  typedef typename ReplacerKey<T>::type key_type;
+  typedef std::set<std::pair<uint64_t, T>> queue_type;
+
+public:
+  explicit LRUKReplacer(size_t k = 2);
+
+  ~LRUKReplacer();
+
+  // disable copy
+  LRUKReplacer(const LRUKReplacer &) = delete;
+  LRUKReplacer &operator=(const LRUKReplacer &) = delete;
+
+  void Insert(const T &value);
+
+  bool Victim(T &value);
+
+  bool Victim(T &value, const VictimFilter<T> &filter);
+
+  bool Erase(const T &value);
+
+  size_t Size();
+
+private:
+  // should be called when holding the lock
+  void Detach(const T &value, const std::deque<uint64_t> &history);
+  void Attach(const T &value, const std::deque<uint64_t> &history);
+
+  const size_t k_;
+  uint64_t current_timestamp_;
+  mutable std::mutex mutex_;
+  // last k access timestamps of every resident page, oldest first
+  std::unordered_map<key_type, std::deque<uint64_t>> history_;
+  // page held by every value the replacer knows about
+  std::unordered_map<T, key_type> frames_;
+  // evictable values with fewer than k accesses, ordered by oldest access
+  queue_type cold_;
+  // evictable values with k accesses, ordered by k-th most recent access
+  queue_type hot_;
+};
+
+} // namespace cmudb
@@ -39,11 +39,16 @@ public:
 
   bool Victim(T &value);
 
+  bool Victim(T &value, const VictimFilter<T> &filter);
+
   bool Erase(const T &value);
 
   size_t Size();
 
 private:
+  // should be called when holding the lock
+  void Unlink(node *cur);
+
   // invariant check
   void check();
 
@@ -0,0 +1,127 @@
+/**
+ * page_guard.h
+ *
+ * Functionality: Move-only handles on a pinned page. A guard owns one pin
+ * (and, for ReadPageGuard/WritePageGuard, the page latch) and gives both
+ * back when it is destroyed, moved over or released explicitly, so a caller
+ * never has to fetch a page again just to unlatch and unpin it.
+ *
+ * Guards are handed out by BufferPoolManager. A guard that holds no page is
+ * empty and tests false, which is what the buffer pool returns when every
+ * frame is pinned.
+ */
+
+#pragma once
+
+#include <utility>
+
+#include "page/page.h"
+
+namespace cmudb {
+
+class BufferPoolManager;
+
+/*
+ * Owns a pin, no latch
+ */
+class PageGuard {
+public:
+  PageGuard() = default;
+  PageGuard(BufferPoolManager *buffer_pool_manager, Page *page);
+
+  ~PageGuard() { Release(); }
+
+  // move only
+  PageGuard(PageGuard &&other) noexcept;
+  PageGuard &operator=(PageGuard &&other) noexcept;
+  PageGuard(const PageGuard &) = delete;
+  PageGuard &operator=(const PageGuard &) = delete;
+
+  // unpin the page now, the guard becomes empty
+  void Release();
+
+  // the page is unpinned as dirty
+  inline void SetDirty() { is_dirty_ = true; }
+
+  inline explicit operator bool() const { return page_ != nullptr; }
+  inline Page *GetPage() const { return page_; }
+  inline page_id_t GetPageId() const { return page_->GetPageId(); }
+  inline char *GetData() const { return page_->GetData(); }
+  // view the page content as a b+ tree page or a header
+  template <typename T> inline T *As() const {
+    return reinterpret_cast<T *>(page_->GetData());
+  }
+
+private:
+  BufferPoolManager *buffer_pool_manager_ = nullptr;
+  Page *page_ = nullptr;
+  bool is_dirty_ = false;
+};
+
+/*
+ * Owns a pin and a shared latch
+ */
+class ReadPageGuard {
+public:
+  ReadPageGuard() = default;
+  // page must be read latched already
+  ReadPageGuard(BufferPoolManager *buffer_pool_manager, Page *page)
+      : guard_(buffer_pool_manager, page) {}
+  // take over the pin of guard, its page must be read latched already
+  explicit ReadPageGuard(PageGuard &&guard) : guard_(std::move(guard)) {}
+
+  ~ReadPageGuard() { Release(); }
+
+  // move only
+  ReadPageGuard(ReadPageGuard &&other) noexcept = default;
+  ReadPageGuard &operator=(ReadPageGuard &&other) noexcept;
+
+  // unlatch and unpin the page now, the guard becomes empty
+  void Release();
+
+  inline explicit operator bool() const { return static_cast<bool>(guard_); }
+  inline Page *GetPage() const { return guard_.GetPage(); }
+  inline page_id_t GetPageId() const { return guard_.GetPageId(); }
+  inline const char *GetData() const { return guard_.GetData(); }
+  // the page types are not const correct, do not modify through this
+  template <typename T> inline T *As() const { return guard_.As<T>(); }
+
+private:
+  PageGuard guard_;
+};
+
+/*
+ * Owns a pin and the exclusive latch
+ */
+class WritePageGuard {
+public:
+  WritePageGuard() = default;
+  // page must be write latched already
+  WritePageGuard(BufferPoolManager *buffer_pool_manager, Page *page)
+      : guard_(buffer_pool_manager, page) {}
+  // take over the pin of guard, its page must be write latched already
+  explicit WritePageGuard(PageGuard &&guard) : guard_(std::move(guard)) {}
+
+  ~WritePageGuard() { Release(); }
+
+  // move only
+  WritePageGuard(WritePageGuard &&other) noexcept = default;
+  WritePageGuard &operator=(WritePageGuard &&other) noexcept;
+
+  // unlatch and unpin the page now, the guard becomes empty
+  void Release();
+
+  // the page is unpinned as dirty
+  inline void SetDirty() { guard_.SetDirty(); }
+
+  inline explicit operator bool() const { return static_cast<bool>(guard_); }
+  inline Page *GetPage() const { return guard_.GetPage(); }
+  inline page_id_t GetPageId() const { return guard_.GetPageId(); }
+  inline char *GetData() const { return guard_.GetData(); }
+  template <typename T> inline T *As() const { return guard_.As<T>(); }
+
+private:
+  PageGuard guard_;
+};
+
+} // namespace cmudb
@@ -6,17 +6,48 @@
 #pragma once
 
 #include <cstdlib>
+#include <functional>
+
+#include "common/config.h"
 
 namespace cmudb {
 
+class Page;
+
+// replacement policy a buffer pool is built with
+enum class ReplacerPolicy { LRU = 0, CLOCK, LRU_K, ARC };
+
+// decides whether an evictable value may be chosen as victim, an empty
+// filter accepts every value
+template <typename T> using VictimFilter = std::function<bool(const T &)>;
+
 template <typename T> class Replacer {
 public:
   Replacer() {}
   virtual ~Replacer() {}
   virtual void Insert(const T &value) = 0;
   virtual bool Victim(T &value) = 0;
+  // the value Victim would choose among those accepted by filter
+  virtual bool Victim(T &value, const VictimFilter<T> &filter) = 0;
   virtual bool Erase(const T &value) = 0;
   virtual size_t Size() = 0;
+  // the buffer pool was resized to num_frames frames
+  virtual void SetNumFrames(size_t num_frames) {}
+};
+
+/*
+ * Identity of the page a replacer value currently holds. A frame is reused
+ * for many pages over time, policies that remember past accesses use this to
+ * attach their history to the page rather than to the frame.
+ */
+template <typename T> struct ReplacerKey {
+  typedef T type;
+  static inline type Get(const T &value) { return value; }
+};
+
+template <> struct ReplacerKey<Page *> {
+  typedef page_id_t type;
+  static type Get(Page *const &value);
 };
 
 } // namespace cmudb
@@ -16,15 +16,38 @@ extern std::chrono::duration<long long int> LOG_TIMEOUT;
 
 extern std::atomic<bool> ENABLE_LOGGING;
 
+extern std::chrono::milliseconds PAGE_CLEANER_INTERVAL;
+
+extern std::chrono::milliseconds PAGE_DUMP_INTERVAL;
+
 #define INVALID_PAGE_ID -1 // representing an invalid page id
 #define INVALID_TXN_ID -1  // representing an invalid txn id
 #define INVALID_LSN -1     // representing an invalid lsn
 #define HEADER_PAGE_ID 0   // the header page id
-#define PAGE_SIZE 512     // size of a data page in byte
+#define PAGE_SIZE 4096    // default size of a data page in byte
+#define MIN_PAGE_SIZE 4096 // smallest page size of a new database
+#define MAX_PAGE_SIZE 65536 // largest page size of a new database
+#define LEGACY_PAGE_SIZE 512 // page size of files without a superblock
+#define CACHELINE_SIZE 64  // size of a cpu cache line in byte
 #define LOG_BUFFER_SIZE                                                            \
   ((BUFFER_POOL_SIZE + 1) * PAGE_SIZE) // size of a log buffer in byte
 #define BUCKET_SIZE 50                 // size of extendible hash bucket
 #define BUFFER_POOL_SIZE 10            // size of buffer pool
+#define BUFFER_POOL_INSTANCES 1        // number of buffer pool shards
+#define BUFFER_POOL_HUGE_PAGES false   // back buffer pool frames with huge pages
+#define BUFFER_POOL_MAX_GROWTH 8       // Resize grows a shard to at most this many times its initial size
+#define BUFFER_POOL_REPLACER ReplacerPolicy::LRU // buffer pool replacer
+#define LRUK_REPLACER_K 2              // history depth of the LRU-K replacer
+#define PAGE_CLEANER_BATCH_SIZE 16     // max pages a cleaner round writes per shard
+#define READ_AHEAD_PAGES 8             // pages prefetched ahead of a sequential scan
+#define SCAN_RING_SIZE 32              // frames of the private ring of a sequential scan
+#define READ_AHEAD_BATCH_PAGES 32      // max adjacent pages read ahead by one vectored read
+#define OPTIMISTIC_READ_RETRIES 4      // optimistic descents before latch crabbing
+#define COMPRESSED_CACHE_SIZE 0        // bytes of compressed evicted pages, 0 disables
+#define DISK_DIRECT_IO false           // bypass the OS page cache for data pages
+#define DIRECT_IO_ALIGNMENT 4096       // buffer/offset alignment of direct I/O
+#define DISK_IO_BACKEND IOBackend::PREAD // backend of asynchronous disk I/O
+#define IO_URING_QUEUE_DEPTH 64        // max io_uring requests in flight
 
 typedef int32_t page_id_t; // page id type
 typedef int32_t txn_id_t;  // transaction id type
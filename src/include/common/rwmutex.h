@@ -2,68 +2,143 @@
  * rwmutex.h
  *
  * Reader-Writer lock
+ *
+ * The whole lock is one 32 bit word: the number of readers in the low bits,
+ * a bit for the writer holding it and one bit each for sleeping writers and
+ * sleeping readers. Uncontended RLock/RUnlock and WLock/WUnlock are a single
+ * atomic operation. A thread that has to wait sets its waiting bit and parks
+ * on the word (a futex on Linux, yield elsewhere); whoever hands the lock
+ * back wakes the sleepers only if a waiting bit is set.
+ *
+ * Writers are preferred: once a writer waits, new readers queue behind it
+ * instead of joining the readers that are still inside.
  */
 
 #pragma once
 
+#include <atomic>
 #include <climits>
-#include <condition_variable>
-#include <mutex>
+#include <cstdint>
+#include <thread>
+
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
 
 namespace cmudb {
 class RWMutex {
 
-  typedef std::mutex mutex_t;
-  typedef std::condition_variable cond_t;
-  static const uint32_t max_readers_ = UINT_MAX;
+  static const uint32_t writer_ = 1u << 31;         // a writer holds the lock
+  static const uint32_t writer_waiting_ = 1u << 30; // a writer sleeps
+  static const uint32_t reader_waiting_ = 1u << 29; // a reader sleeps
+  static const uint32_t waiting_ = writer_waiting_ | reader_waiting_;
+  static const uint32_t max_readers_ = reader_waiting_ - 1;
 
 public:
-  RWMutex() : reader_count_(0), writer_entered_(false) {}
+  RWMutex() : state_(0) {}
 
-  ~RWMutex() { std::lock_guard<mutex_t> guard(mutex_); }
+  ~RWMutex() = default;
 
   RWMutex(const RWMutex &) = delete;
   RWMutex &operator=(const RWMutex &) = delete;
 
   void WLock() {
-    std::unique_lock<mutex_t> lock(mutex_);
-    while (writer_entered_)
-      reader_.wait(lock);
-    writer_entered_ = true;
-    while (reader_count_ > 0)
-      writer_.wait(lock);
+    uint32_t state = state_.load(std::memory_order_relaxed);
+    while (true) {
+      if ((state & (writer_ | max_readers_)) == 0) {
+        // keep the waiting bits, the sleepers are woken on unlock
+        if (state_.compare_exchange_weak(state, state | writer_,
+                                         std::memory_order_acquire,
+                                         std::memory_order_relaxed))
+          return;
+        continue;
+      }
+      if ((state & writer_waiting_) == 0) {
+        if (!state_.compare_exchange_weak(state, state | writer_waiting_,
+                                          std::memory_order_relaxed))
+          continue;
+        state |= writer_waiting_;
+      }
+      Wait(state);
+      state = state_.load(std::memory_order_relaxed);
+    }
   }
 
   void WUnlock() {
-    std::lock_guard<mutex_t> guard(mutex_);
-    writer_entered_ = false;
-    reader_.notify_all();
+    if (state_.exchange(0, std::memory_order_release) & waiting_)
+      WakeAll();
   }
 
   void RLock() {
-    std::unique_lock<mutex_t> lock(mutex_);
-    while (writer_entered_ || reader_count_ == max_readers_)
-      reader_.wait(lock);
-    reader_count_++;
+    uint32_t state = state_.load(std::memory_order_relaxed);
+    while (true) {
+      if ((state & (writer_ | writer_waiting_)) == 0 &&
+          (state & max_readers_) != max_readers_) {
+        if (state_.compare_exchange_weak(state, state + 1,
+                                         std::memory_order_acquire,
+                                         std::memory_order_relaxed))
+          return;
+        continue;
+      }
+      if ((state & reader_waiting_) == 0) {
+        if (!state_.compare_exchange_weak(state, state | reader_waiting_,
+                                          std::memory_order_relaxed))
+          continue;
+        state |= reader_waiting_;
+      }
+      Wait(state);
+      state = state_.load(std::memory_order_relaxed);
+    }
+  }
+
+  // take the lock for reading only if that does not have to wait
+  bool TryRLock() {
+    uint32_t state = state_.load(std::memory_order_relaxed);
+    while ((state & (writer_ | writer_waiting_)) == 0 &&
+           (state & max_readers_) != max_readers_) {
+      if (state_.compare_exchange_weak(state, state + 1,
+                                       std::memory_order_acquire,
+                                       std::memory_order_relaxed))
+        return true;
+    }
+    return false;
   }
 
   void RUnlock() {
-    std::lock_guard<mutex_t> guard(mutex_);
-    reader_count_--;
-    if (writer_entered_) {
-      if (reader_count_ == 0)
-        writer_.notify_one();
-    } else {
-      if (reader_count_ == max_readers_ - 1)
-        reader_.notify_one();
+    uint32_t state = state_.fetch_sub(1, std::memory_order_release) - 1;
+    // the last reader out clears the waiting bits and wakes the sleepers,
+    // unless a writer or a new reader got in first and will do it instead
+    while ((state & ~waiting_) == 0 && (state & waiting_) != 0) {
+      if (state_.compare_exchange_weak(state, 0, std::memory_order_relaxed)) {
+        WakeAll();
+        return;
+      }
     }
   }
 
 private:
-  mutex_t mutex_;
-  cond_t writer_;
-  cond_t reader_;
-  uint32_t reader_count_;
-  bool writer_entered_;
+  // sleep until the word no longer holds state
+  void Wait(uint32_t state) {
+#ifdef __linux__
+    syscall(SYS_futex, reinterpret_cast<uint32_t *>(&state_),
+            FUTEX_WAIT_PRIVATE, state, nullptr, nullptr, 0);
+#else
+    while (state_.load(std::memory_order_relaxed) == state)
+      std::this_thread::yield();
+#endif
+  }
+
+  void WakeAll() {
+#ifdef __linux__
+    syscall(SYS_futex, reinterpret_cast<uint32_t *>(&state_),
+            FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0);
+#endif
+  }
+
+  std::atomic<uint32_t> state_;
+  static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t),
+                "the futex needs a plain 32 bit word");
 };
 } // namespace cmudb
@@ -5,31 +5,134 @@
  * database. It also performs read and write of pages to and from disk, and
  * provides a logical file layer within the context of a database management
  * system.
+ *
+ * The page size is chosen when the database file is created and recorded in
+ * a superblock at the beginning of the file, page 0 starts right after it.
+ * Pages are allocated from bitmap pages kept in the file, one in front of
+ * every group of pages (see PageAllocator), so deallocated pages are reused
+ * and the allocation state survives a restart. Changed bitmaps are written
+ * ahead of the next data page write and are durable after Sync. Files
+ * written before the bitmaps existed keep allocating at the end of the file.
+ *
+ * Data pages are read and written with pread/pwrite on a plain file
+ * descriptor, runs of adjacent pages with preadv/pwritev: there is no shared
+ * file cursor, so buffer pool instances can do page I/O concurrently without
+ * a latch. With direct_io the file is opened O_DIRECT and the buffer pool is
+ * the only cache of the pages; buffers that are not aligned to
+ * DIRECT_IO_ALIGNMENT go through an aligned copy. Direct I/O silently falls
+ * back to buffered I/O where the file system or the page size does not allow
+ * it.
+ *
+ * ReadPageAsync/WritePageAsync/WriteLogAsync return a future instead of
+ * waiting for the disk. With the IO_URING backend they go through an
+ * io_uring ring: requests queued with submit = false are handed to the
+ * kernel together by the next submitting call or SubmitIO. With the PREAD
+ * backend, or when the kernel has no io_uring, they complete synchronously
+ * and return a ready future.
+ *
+ * MapFile maps the file read-only for read-only buffer pools, which point
+ * their frames at the mapped pages rather than copying them (see
+ * BufferPoolManager). A write through pwrite would change such a page under
+ * a reader that has it pinned, so the mapping and writing buffer pools
+ * exclude each other: MapFile fails while a writer is registered with
+ * AddWriter, and AddWriter fails while a pool maps the file.
  */
 
 #pragma once
+#include <algorithm>
 #include <atomic>
+#include <cstdint>
 #include <fstream>
 #include <future>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <sys/uio.h>
+#include <utility>
+#include <vector>
 
 #include "common/config.h"
+#include "disk/io_uring.h"
+#include "disk/page_allocator.h"
 
 namespace cmudb {
 
+// how the asynchronous page and log calls are carried out
+enum class IOBackend { PREAD = 0, IO_URING };
+
+// access pattern hint for the file mapping
+enum class MapAdvice { NORMAL = 0, SEQUENTIAL, WILLNEED };
+
 class DiskManager {
 public:
-  DiskManager(const std::string &db_file);
+  DiskManager(const std::string &db_file, size_t page_size = PAGE_SIZE,
+              bool direct_io = DISK_DIRECT_IO,
+              IOBackend backend = DISK_IO_BACKEND);
   ~DiskManager();
 
   void WritePage(page_id_t page_id, const char *page_data);
   void ReadPage(page_id_t page_id, char *page_data);
+  // read/write pages [first_page_id, first_page_id + num_pages) with one
+  // vectored system call per IOV_MAX pages. WritePages does not sync, call
+  // Sync afterwards
+  void ReadPages(page_id_t first_page_id, char *const *pages_data,
+                 size_t num_pages);
+  void WritePages(page_id_t first_page_id, const char *const *pages_data,
+                  size_t num_pages);
+  // make the writes so far durable
+  void Sync();
+  // whether data pages bypass the OS page cache
+  inline bool IsDirectIO() const { return direct_io_; }
+
+  // asynchronous counterparts, the future is false on an I/O error. the
+  // buffer must stay valid until the future is ready
+  std::future<bool> ReadPageAsync(page_id_t page_id, char *page_data,
+                                  bool submit = true);
+  std::future<bool> WritePageAsync(page_id_t page_id, const char *page_data,
+                                   bool submit = true);
+  // append to the log, without a log write of WriteLog in between
+  std::future<bool> WriteLogAsync(const char *log_data, int size,
+                                  bool submit = true);
+  // hand the requests queued with submit = false to the kernel
+  void SubmitIO();
+  // IO_URING only if the ring could be set up
+  inline IOBackend GetIOBackend() const {
+    return io_uring_ != nullptr ? IOBackend::IO_URING : IOBackend::PREAD;
+  }
+
+  // map the db file read-only for a buffer pool, false if it can not be
+  // mapped or a writer is registered. UnmapFile once the pool is gone
+  bool MapFile();
+  void UnmapFile();
+  // register a buffer pool that writes pages, false while the file is mapped
+  bool AddWriter();
+  void RemoveWriter();
+  // page_id within the mapping, nullptr if the file is not mapped or the
+  // page is past the end of the file. valid until the disk manager goes away
+  const char *GetMappedPage(page_id_t page_id);
+  // hint for pages [first_page_id, first_page_id + num_pages) of the
+  // mapping, num_pages = 0 for the whole file
+  void AdviseMapping(MapAdvice advice, page_id_t first_page_id = 0,
+                     size_t num_pages = 0);
 
   void WriteLog(char *log_data, int size);
   bool ReadLog(char *log_data, int size, int offset);
 
-  page_id_t AllocatePage();
+  page_id_t AllocatePage(page_id_t near = INVALID_PAGE_ID);
   void DeallocatePage(page_id_t page_id);
+  // false for a deallocated page or one that was never allocated
+  inline bool IsAllocated(page_id_t page_id) const {
+    return allocator_ != nullptr ? allocator_->IsAllocated(page_id)
+                                 : page_id >= 0 && page_id < next_page_id_;
+  }
+  // no page at or above this id is allocated
+  inline page_id_t GetNextPageId() const {
+    return allocator_ != nullptr ? allocator_->GetNextPageId()
+                                 : next_page_id_.load();
+  }
+
+  // size of a data page in byte
+  inline size_t GetPageSize() const { return page_size_; }
 
   int GetNumFlushes() const;
   bool GetFlushState() const;
@@ -37,13 +140,67 @@ public:
   inline bool HasFlushLogFuture() { return flush_log_f_ != nullptr; }
 
 private:
-  int GetFileSize(const std::string &name);
+  long long GetFileSize(const std::string &name);
+  void WriteSuperblock();
+  void ReadSuperblock();
+  void EnableDirectIO();
+  void WriteBitmaps();
+  bool Remap();
+  // file offset of a data page, the bitmap page of its group comes first
+  inline size_t PageOffset(page_id_t page_id) const {
+    if (allocator_ == nullptr) {
+      return data_offset_ + static_cast<size_t>(page_id) * page_size_;
+    }
+    size_t group = page_id / allocator_->GetPagesPerGroup();
+    return data_offset_ +
+           (static_cast<size_t>(page_id) + group + 1) * page_size_;
+  }
+  // how many of num_pages pages from page_id are contiguous in the file
+  inline size_t GetRunLength(page_id_t page_id, size_t num_pages) const {
+    if (allocator_ == nullptr) {
+      return num_pages;
+    }
+    size_t group_size = allocator_->GetPagesPerGroup();
+    return std::min(num_pages, group_size - page_id % group_size);
+  }
+  // positional I/O on the db file, retried until size bytes are transferred.
+  // PRead returns the bytes read, fewer at the end of the file
+  size_t PRead(char *data, size_t size, size_t offset);
+  bool PWrite(const char *data, size_t size, size_t offset);
+  size_t VectoredIO(bool write, struct iovec *iov, size_t iovcnt,
+                    size_t offset);
+  static bool WriteFully(int fd, const char *data, size_t size,
+                         size_t offset);
+  // whether data can be used for I/O on the db file as it is
+  inline bool IsAligned(const void *data) const {
+    return !direct_io_ ||
+           reinterpret_cast<uintptr_t>(data) % DIRECT_IO_ALIGNMENT == 0;
+  }
   // stream to write log file
   std::fstream log_io_;
   std::string log_name_;
-  // stream to write db file
-  std::fstream db_io_;
+  // descriptor of the db file, pread/pwrite need no latch
+  int db_fd_;
+  bool direct_io_;
+  // asynchronous I/O, nullptr with the PREAD backend
+  std::unique_ptr<IoUring> io_uring_;
+  // descriptor for asynchronous log appends and the log size they start at
+  int log_fd_;
+  std::atomic<size_t> log_size_;
   std::string file_name_;
+  size_t page_size_;
+  size_t data_offset_; // file offset of page 0
+  // read-only mapping of the file, with the older (smaller) ones kept alive
+  std::mutex map_latch_;
+  std::atomic<char *> map_data_;
+  std::atomic<size_t> map_size_;
+  int map_advice_; // madvise flag for the whole file
+  int num_map_users_; // pools serving pages from the mapping
+  int num_writers_;   // pools that may write pages
+  std::vector<std::pair<char *, size_t>> mappings_;
+  // free space map, nullptr for files without bitmaps
+  std::unique_ptr<PageAllocator> allocator_;
+  std::mutex bitmap_latch_; // one WriteBitmaps at a time
   std::atomic<page_id_t> next_page_id_;
   int num_flushes_;
   bool flush_log_;
@@ -0,0 +1,82 @@
+/**
+ * io_uring.h
+ *
+ * Functionality: Minimal io_uring ring for the disk manager's asynchronous
+ * page and log I/O, driven through the raw system calls (no liburing).
+ * Requests are queued into the submission ring and handed to the kernel
+ * together by Submit, so a batch of reads or writes costs one system call.
+ * A completion thread reaps the completion ring and runs the callback of
+ * each request with its result: the bytes transferred or -errno.
+ *
+ * The ring is unavailable when the kernel or its seccomp policy does not
+ * provide io_uring, callers then fall back to synchronous I/O.
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <sys/types.h>
+#include <thread>
+
+namespace cmudb {
+
+typedef std::function<void(ssize_t)> IoCallback;
+
+class IoUring {
+public:
+  explicit IoUring(unsigned queue_depth);
+  ~IoUring();
+
+  // disable copy
+  IoUring(const IoUring &) = delete;
+  IoUring &operator=(const IoUring &) = delete;
+
+  inline bool IsAvailable() const { return ring_fd_ != -1; }
+
+  // queue a read/write of size bytes at offset of fd, callback runs on the
+  // completion thread. blocks while queue depth requests are in flight
+  void Read(int fd, char *data, size_t size, size_t offset,
+            IoCallback callback);
+  void Write(int fd, const char *data, size_t size, size_t offset,
+             IoCallback callback);
+
+  // hand the queued requests to the kernel
+  void Submit();
+
+private:
+  struct Request;
+
+  void Queue(unsigned char opcode, int fd, const char *data, size_t size,
+             size_t offset, IoCallback callback);
+  // should be called when holding the latch, with room in the ring
+  void Prepare(unsigned char opcode, int fd, size_t offset,
+               Request *request);
+  // should be called when holding the latch. return false if the kernel
+  // refused the queued requests, they are completed with -errno
+  bool SubmitLocked();
+  // body of the completion thread
+  void Reap();
+
+  int ring_fd_;
+  unsigned sq_entries_;
+  // mapped rings
+  void *sq_ring_;
+  size_t sq_ring_size_;
+  void *cq_ring_;
+  size_t cq_ring_size_;
+  void *sqes_;
+  size_t sqes_size_;
+  unsigned *sq_head_, *sq_tail_, *sq_mask_, *sq_array_;
+  unsigned *cq_head_, *cq_tail_, *cq_mask_;
+  void *cqes_;
+
+  unsigned to_submit_;   // queued but not handed to the kernel yet
+  unsigned in_flight_;   // queued or submitted, not completed
+  std::mutex latch_;     // to protect the submission ring
+  std::condition_variable cv_;
+  std::thread reaper_;
+};
+
+} // namespace cmudb
@@ -0,0 +1,84 @@
+/**
+ * page_allocator.h
+ *
+ * Functionality: Free space map of a database file. Pages are grouped, each
+ * group is described by one bitmap page with a bit per page of the group,
+ * so a group holds page_size * 8 pages. The disk manager keeps the bitmap
+ * pages in the file in front of their groups and hands them to the
+ * allocator when the file is opened; the allocator tells which bitmaps
+ * changed so they can be written back.
+ *
+ * The 8 pages of one bitmap byte form an extent. An allocation near a page
+ * takes a free page of that page's extent, or opens a new free extent, so
+ * the pages of one table heap or index come in physically sequential runs.
+ * Other allocations take the lowest free page, which reuses deallocated
+ * pages before the file grows.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "common/config.h"
+
+namespace cmudb {
+
+class PageAllocator {
+public:
+  explicit PageAllocator(size_t page_size);
+
+  // disable copy
+  PageAllocator(const PageAllocator &) = delete;
+  PageAllocator &operator=(const PageAllocator &) = delete;
+
+  // number of pages described by one bitmap page
+  inline size_t GetPagesPerGroup() const { return pages_per_group_; }
+
+  // append a group with the bitmap read from disk, nullptr for an empty one
+  void AddGroup(const char *bitmap);
+  size_t GetNumGroups();
+
+  // near: a page of the structure the new page belongs to, or
+  // INVALID_PAGE_ID. new groups are added as needed
+  page_id_t Allocate(page_id_t near = INVALID_PAGE_ID);
+  // return false if page_id was not allocated
+  bool Deallocate(page_id_t page_id);
+  bool IsAllocated(page_id_t page_id);
+
+  // no page at or above this id is allocated
+  inline page_id_t GetNextPageId() const { return next_page_id_; }
+
+  // whether a bitmap changed since the last TakeDirtyGroups
+  inline bool IsDirty() const { return dirty_; }
+  // copies of the bitmaps changed since the last call, with their group
+  void
+  TakeDirtyGroups(std::vector<std::pair<size_t, std::vector<char>>> &groups);
+  // the bitmap of group has to be written again, e.g. after an I/O error
+  void MarkDirty(size_t group);
+
+private:
+  // should be called when holding the latch. byte_index counts bitmap
+  // bytes across all groups, like page ids count pages across them
+  inline unsigned char &ByteAt(size_t byte_index) {
+    return bitmaps_[byte_index / page_size_][byte_index % page_size_];
+  }
+  page_id_t Take(size_t byte_index, int bit);
+  bool FindFreeExtent(size_t &byte_index);
+  bool FindFreePage(size_t &byte_index, int &bit);
+
+  size_t page_size_;                       // bytes of one bitmap
+  size_t pages_per_group_;
+  std::vector<std::vector<unsigned char>> bitmaps_;
+  std::vector<bool> group_dirty_;
+  // no free page / free extent in a bitmap byte below these
+  size_t first_free_page_;
+  size_t first_free_extent_;
+  std::atomic<page_id_t> next_page_id_;
+  std::atomic<bool> dirty_;
+  std::mutex latch_;                       // to protect the bitmaps
+};
+
+} // namespace cmudb
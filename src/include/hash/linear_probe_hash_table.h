@@ -0,0 +1,93 @@
+/*
+ * linear_probe_hash_table.h : fixed capacity open addressing hash table
+ *
+ * Functionality: Page table of a buffer pool instance. The number of entries
+ * can never exceed the number of frames, so the table is allocated once with
+ * at least twice that many slots and never grows or allocates afterwards.
+ *
+ * Collisions are resolved with linear probing. Every slot is guarded by its
+ * own version counter (a seqlock): writers make it odd while they update the
+ * slot, readers sample it before and after reading and retry on a change.
+ * A consistent slot does not make a consistent probe sequence, so the table
+ * has a seqlock epoch as well, odd while an Insert or Remove adds or drops a
+ * key. A miss that overlapped such a change is retried. Find therefore never
+ * takes a lock and never writes shared memory. Insert and Remove are
+ * serialized by a writer latch, which in the buffer pool is uncontended
+ * because the instance latch is already held.
+ *
+ * Removed entries leave a tombstone behind so that probe sequences stay
+ * intact. A run of tombstones that ends at an empty slot is turned back into
+ * empty slots, which keeps tombstones from piling up under churn.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+#include "hash/hash_table.h"
+
+namespace cmudb {
+
+// only support unique key, K and V must be trivially copyable
+template <typename K, typename V>
+class LinearProbeHashTable : public HashTable<K, V> {
+  enum SlotState : uint8_t { EMPTY = 0, OCCUPIED, TOMBSTONE };
+
+  struct Slot {
+    std::atomic<uint32_t> version{0}; // odd while a writer owns the slot
+    std::atomic<uint8_t> state{EMPTY};
+    std::atomic<K> key{K()};
+    std::atomic<V> value{V()};
+  };
+
+public:
+  // capacity: largest number of entries the table has to hold
+  explicit LinearProbeHashTable(size_t capacity);
+
+  // disable copy
+  LinearProbeHashTable(const LinearProbeHashTable &) = delete;
+  LinearProbeHashTable &operator=(const LinearProbeHashTable &) = delete;
+
+  // lookup and modifier
+  bool Find(const K &key, V &value) override;
+
+  bool Remove(const K &key) override;
+
+  void Insert(const K &key, const V &value) override;
+
+  size_t Size() const override { return size_.load(); }
+
+  // number of slots, always a power of two
+  size_t GetNumSlots() const { return num_slots_; }
+
+private:
+  inline size_t HomeSlot(const K &key) const {
+    // fibonacci hashing, spreads page ids that share a residue modulo the
+    // number of buffer pool instances
+    return (static_cast<uint64_t>(key) * 11400714819323198485ull) >>
+           (64 - slot_bits_);
+  }
+  inline size_t NextSlot(size_t index) const {
+    return (index + 1) & (num_slots_ - 1);
+  }
+
+  // should be called when holding write latch
+  void BeginWrite();
+  void EndWrite();
+  // should be called when holding write latch
+  void WriteSlot(Slot &slot, SlotState state, const K &key, const V &value);
+  // should be called when holding write latch, return num_slots_ if absent
+  size_t FindSlot(const K &key) const;
+
+  size_t num_slots_;
+  int slot_bits_;
+  std::unique_ptr<Slot[]> slots_;
+  std::atomic<size_t> size_;
+  std::atomic<uint64_t> epoch_; // odd while Insert/Remove add or drop a key
+  std::mutex write_latch_;      // serialize Insert/Remove
+};
+
+} // namespace cmudb
@@ -11,6 +11,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <queue>
 #include <vector>
 
@@ -70,6 +71,16 @@ public:
                Transaction *transaction = nullptr);
 
 private:
+  // find the leaf for a lookup or a scan, return it read latched. an empty
+  // guard means the tree is empty
+  ReadPageGuard FindLeafPageRead(const KeyType &key, bool leftMost = false);
+  // descent validating page versions instead of latching inner nodes.
+  // return false if a writer interfered and the descent has to restart
+  bool FindLeafPageOptimistic(const KeyType &key, bool leftMost,
+                              ReadPageGuard &leaf);
+  // descent with read latch crabbing
+  ReadPageGuard FindLeafPageCrabbing(const KeyType &key, bool leftMost);
+
   class Checker {
   public:
     explicit Checker(BufferPoolManager *b) : buffer(b) {}
@@ -124,7 +135,9 @@ private:
   std::string index_name_;
   std::mutex mutex_;                       // protect `root_page_id_` from concurrent modification
   static thread_local bool root_is_locked; // root is locked?
-  page_id_t root_page_id_;
+  // read without mutex_ by optimistic descents, so a new root is only
+  // published once its page is initialized
+  std::atomic<page_id_t> root_page_id_;
   BufferPoolManager *buffer_pool_manager_;
   KeyComparator comparator_;
 };
@@ -1,6 +1,9 @@
 /**
  * index_iterator.h
- * For range scan of b+ tree
+ * For range scan of b+ tree. Leaves are prefetched along the sibling chain,
+ * a window of READ_AHEAD_PAGES at a time while they are laid out
+ * sequentially, one leaf ahead otherwise.
+ * The current leaf stays read latched and pinned through its page guard.
  */
 
 #pragma once
@@ -16,11 +19,9 @@ namespace cmudb {
 template <typename KeyType, typename ValueType, typename KeyComparator>
 class IndexIterator {
 public:
-  // you may define your own constructor based on your member variables
-  IndexIterator(BPlusTreeLeafPage<KeyType, ValueType, KeyComparator> *,
-                int, BufferPoolManager *);
-
-  ~IndexIterator();
+  // leaf: read latched leaf to start from, may be empty
+  IndexIterator(ReadPageGuard &&leaf, int index,
+                BufferPoolManager *buff_pool_manager);
 
   bool isEnd();
 
@@ -29,10 +30,15 @@ public:
   IndexIterator &operator++();
 
 private:
+  // prefetch the leaves after leaf_, which was reached from prev_page_id
+  void ReadAhead(page_id_t prev_page_id);
+
   // add your own private member variables here
+  ReadPageGuard guard_;
   BPlusTreeLeafPage<KeyType, ValueType, KeyComparator> *leaf_;
   int index_;
   BufferPoolManager *buff_pool_manager_;
+  page_id_t read_ahead_end_; // pages before this one have been prefetched
 };
 
 } // namespace cmudb
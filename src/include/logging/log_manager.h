@@ -10,6 +10,7 @@
 #include <condition_variable>
 #include <future>
 #include <mutex>
+#include <thread>
 
 #include "disk/disk_manager.h"
 #include "logging/log_record.h"
@@ -19,7 +20,8 @@ namespace cmudb {
 class LogManager {
 public:
   LogManager(DiskManager *disk_manager)
-      : next_lsn_(0), persistent_lsn_(INVALID_LSN),
+      : next_lsn_(0), persistent_lsn_(INVALID_LSN), offset_(0),
+        flush_requested_(false), flush_thread_(nullptr),
         disk_manager_(disk_manager) {
     // TODO: you may intialize your own defined memeber variables here
     log_buffer_ = new char[LOG_BUFFER_SIZE];
@@ -27,6 +29,9 @@ public:
   }
 
   ~LogManager() {
+    if (flush_thread_ != nullptr) {
+      StopFlushThread();
+    }
     delete[] log_buffer_;
     delete[] flush_buffer_;
     log_buffer_ = nullptr;
@@ -39,14 +44,18 @@ public:
   // append a log record into log buffer
   lsn_t AppendLogRecord(LogRecord &log_record);
 
+  // ask the flush thread for a flush and block until lsn is persistent, or
+  // logging is turned off
+  void WaitUntilPersistent(lsn_t lsn);
+
   // get/set helper functions
   inline lsn_t GetPersistentLSN() { return persistent_lsn_; }
-  inline void SetPersistentLSN(lsn_t lsn) { persistent_lsn_ = lsn; }
+  void SetPersistentLSN(lsn_t lsn);
   inline char *GetLogBuffer() { return log_buffer_; }
 
 private:
-  // TODO: you may add your own member variables
-  // also remember to change constructor accordingly
+  // body of the flush thread
+  void FlushThread();
 
   // atomic counter, record the next log sequence number
   std::atomic<lsn_t> next_lsn_;
@@ -55,12 +64,22 @@ private:
   // log buffer related
   char *log_buffer_;
   char *flush_buffer_;
+  // bytes of log records in log_buffer_
+  int offset_;
+  // set by WaitUntilPersistent and by appenders that found the log buffer
+  // full, the flush thread flushes right away
+  bool flush_requested_;
   // latch to protect shared member variables
   std::mutex latch_;
   // flush thread
   std::thread *flush_thread_;
   // for notifying flush thread
   std::condition_variable cv_;
+  // for notifying appenders that the log buffer was swapped
+  std::condition_variable append_cv_;
+  // for notifying threads waiting in WaitUntilPersistent
+  std::mutex persistent_latch_;
+  std::condition_variable persistent_cv_;
   // disk manager
   DiskManager *disk_manager_;
 };
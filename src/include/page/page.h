@@ -4,23 +4,36 @@
  * Wrapper around actual data page in main memory and also contains bookkeeping
  * information used by buffer pool manager like pin_count/dirty_flag/page_id.
  * Use page as a basic unit within the database system
+ *
+ * Besides the reader-writer latch every page has a version counter for
+ * optimistic reads. WLatch makes it odd and WUnlatch even again, so a reader
+ * that samples it with ReadVersion, reads the page without any latch and
+ * sees the same value in ValidateVersion knows no writer was active in
+ * between. Optimistic readers must still pin the page.
  */
 
 #pragma once
 
+#include <atomic>
+#include <cstdint>
 #include <cstring>
 #include <iostream>
+#include <thread>
 
 #include "common/config.h"
 #include "common/rwmutex.h"
 
 namespace cmudb {
 
-class Page {
-  friend class BufferPoolManager;
+struct FrameRing;
+
+// padded to a cache line, see FrameArena
+class alignas(CACHELINE_SIZE) Page {
+  friend class BufferPoolManagerInstance;
+  friend class FrameArena;
 
 public:
-  Page() { ResetMemory(); }
+  Page() {}
   ~Page() {};
 
   // disable copy
@@ -30,6 +43,9 @@ public:
   // get actual data page content
   inline char *GetData() { return data_; }
 
+  // get size of the data page in byte
+  inline size_t GetPageSize() { return page_size_; }
+
   // get page id
   inline page_id_t GetPageId() { return page_id_; }
 
@@ -37,24 +53,53 @@ public:
   inline int GetPinCount() { return pin_count_; }
 
   // method use to latch/unlatch page content
-  inline void WUnlatch() { rwlatch_.WUnlock(); }
-  inline void WLatch() { rwlatch_.WLock(); }
+  inline void WUnlatch() {
+    version_.store(version_.load(std::memory_order_relaxed) + 1,
+                   std::memory_order_release);
+    rwlatch_.WUnlock();
+  }
+  inline void WLatch() {
+    rwlatch_.WLock();
+    version_.store(version_.load(std::memory_order_relaxed) + 1,
+                   std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+  }
   inline void RUnlatch() { rwlatch_.RUnlock(); }
   inline void RLatch() { rwlatch_.RLock(); }
+  inline bool TryRLatch() { return rwlatch_.TryRLock(); }
+
+  // optimistic read: wait until no writer holds the page, return the version
+  inline uint64_t ReadVersion() {
+    uint64_t version;
+    while ((version = version_.load(std::memory_order_acquire)) & 1) {
+      std::this_thread::yield();
+    }
+    return version;
+  }
+  // true if no writer latched the page since ReadVersion returned version
+  inline bool ValidateVersion(uint64_t version) {
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return version_.load(std::memory_order_relaxed) == version;
+  }
 
   inline lsn_t GetLSN() { return *reinterpret_cast<lsn_t *>(GetData() + 4); }
   inline void SetLSN(lsn_t lsn) { memcpy(GetData() + 4, &lsn, 4); }
 
 private:
   // method used by buffer pool manager
-  inline void ResetMemory() { memset(data_, 0, PAGE_SIZE); }
+  inline void ResetMemory() { memset(data_, 0, page_size_); }
 
   // members
-  char data_[PAGE_SIZE]; // actual data
+  char *data_ = nullptr; // actual data, owned by buffer pool manager
+  size_t page_size_ = 0;
   page_id_t page_id_ = INVALID_PAGE_ID;
   int pin_count_ = 0;
   bool is_dirty_ = false;
+  bool io_in_progress_ = false; // frame is being read/written without latch
+  FrameRing *ring_ = nullptr;   // access strategy ring holding the frame
+  uint64_t last_access_ = 0;    // access clock of the instance at last fetch
   RWMutex rwlatch_;
+  std::atomic<uint64_t> version_{0}; // odd while write latched
 };
 
 } // namespace cmudb
@@ -46,7 +46,9 @@ public:
 
   bool DeleteTableHeap();
 
-  TableIterator begin(Transaction *txn);
+  // a sequential scan, through the ring of strategy if there is one
+  TableIterator begin(Transaction *txn,
+                      std::shared_ptr<BufferAccessStrategy> strategy = nullptr);
 
   TableIterator end();
 
@@ -1,25 +1,34 @@
 /**
  * table_iterator.h
  *
- * For seq scan of table heap
+ * For seq scan of table heap. While the page chain is laid out
+ * sequentially on disk the iterator keeps a window of READ_AHEAD_PAGES pages
+ * being prefetched, otherwise it stays one page ahead along the chain.
+ *
+ * Given an access strategy, the pages read by the scan and its read-ahead
+ * cycle through the ring of the strategy instead of the whole buffer pool.
  */
 
 #pragma once
 
 #include <cassert>
+#include <memory>
 
 #include "common/rid.h"
 #include "table/tuple.h"
 
 namespace cmudb {
 
+class BufferAccessStrategy;
 class TableHeap;
+class TablePage;
 
 class TableIterator {
   friend class Cursor;
 
 public:
-  TableIterator(TableHeap *table_heap, RID rid, Transaction *txn);
+  TableIterator(TableHeap *table_heap, RID rid, Transaction *txn,
+                std::shared_ptr<BufferAccessStrategy> strategy = nullptr);
 
   ~TableIterator() { delete tuple_; }
 
@@ -40,9 +49,14 @@ public:
   TableIterator operator++(int);
 
 private:
+  // prefetch the pages after page, which was reached from prev_page_id
+  void ReadAhead(page_id_t prev_page_id, TablePage *page);
+
   TableHeap *table_heap_;
   Tuple *tuple_;
   Transaction *txn_;
+  page_id_t read_ahead_end_; // pages before this one have been prefetched
+  std::shared_ptr<BufferAccessStrategy> strategy_;
 };
 
 } // namespace cmudb
\ No newline at end of file
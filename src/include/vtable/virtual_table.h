@@ -72,7 +72,14 @@ public:
     log_manager_ = new LogManager(disk_manager_);
 
     buffer_pool_manager_ =
-        new BufferPoolManager(BUFFER_POOL_SIZE, disk_manager_, log_manager_);
+        new BufferPoolManager(BUFFER_POOL_SIZE, disk_manager_, log_manager_,
+                              BUFFER_POOL_INSTANCES, BUFFER_POOL_REPLACER,
+                              COMPRESSED_CACHE_SIZE);
+    // warm the pool up with the pages that were resident at the last dump
+    warmup_file_name_ = db_file_name.substr(0, db_file_name.find(".")) +
+                        ".warmup";
+    buffer_pool_manager_->LoadPages(warmup_file_name_);
+    buffer_pool_manager_->RunPageDumper(warmup_file_name_);
 
     // txn related
     lock_manager_ = new LockManager(true); // S2PL
@@ -82,11 +89,15 @@ public:
   ~StorageEngine() {
     if (ENABLE_LOGGING)
       log_manager_->StopFlushThread();
-    delete disk_manager_;
+    buffer_pool_manager_->StopPageDumper();
+    buffer_pool_manager_->DumpPages(warmup_file_name_);
+    // the buffer pool joins threads that still use the disk manager and log
+    // manager, tear everything down in reverse order of construction
+    delete transaction_manager_;
+    delete lock_manager_;
     delete buffer_pool_manager_;
     delete log_manager_;
-    delete lock_manager_;
-    delete transaction_manager_;
+    delete disk_manager_;
   }
 
   DiskManager *disk_manager_;
@@ -94,6 +105,7 @@ public:
   LockManager *lock_manager_;
   TransactionManager *transaction_manager_;
   LogManager *log_manager_;
+  std::string warmup_file_name_;
 };
 
 StorageEngine *storage_engine_;
@@ -172,7 +184,10 @@ public:
     return table_heap_->UpdateTuple(tuple, rid, GetTransaction());
   }
 
-  inline TableIterator begin() { return table_heap_->begin(GetTransaction()); }
+  inline TableIterator
+  begin(std::shared_ptr<BufferAccessStrategy> strategy = nullptr) {
+    return table_heap_->begin(GetTransaction(), std::move(strategy));
+  }
 
   inline TableIterator end() { return table_heap_->end(); }
 
@@ -200,8 +215,14 @@ public:
       : table_iterator_(virtual_table->begin()), virtual_table_(virtual_table) {
   }
 
+  // an index scan never moves the iterator past the first page, only a
+  // sequential scan reads through its own ring of frames
   inline void SetScanFlag(bool is_index_scan) {
     is_index_scan_ = is_index_scan;
+    if (!is_index_scan_ && table_iterator_.strategy_ == nullptr) {
+      table_iterator_.strategy_ =
+          storage_engine_->buffer_pool_manager_->GetAccessStrategy();
+    }
   }
 
   inline bool IsIndexScan() { return is_index_scan_; }
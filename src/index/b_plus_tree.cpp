@@ -49,27 +49,17 @@ GetValue(const KeyType &key, std::vector<ValueType> &result,
   // for debug
   //__attribute__((unused)) auto checker = Checker{buffer_pool_manager_};
 
-  auto *leaf = FindLeafPage(key, false, Operation::READONLY, transaction);
-  bool ret = false;
-  if (leaf != nullptr) {
-    ValueType value;
-    if (leaf->Lookup(key, value, comparator_)) {
-      result.push_back(value);
-      ret = true;
-    }
-    UnlockUnpinPages(Operation::READONLY, transaction);
-
-    // in case of `transaction` is nullptr
-    if (transaction == nullptr) {
-      auto page_id = leaf->GetPageId();
-      // unlock and unpin
-      buffer_pool_manager_->FetchPage(page_id)->RUnlatch();
-      buffer_pool_manager_->UnpinPage(page_id, false);
-      // unpin again
-      buffer_pool_manager_->UnpinPage(page_id, false);
-    }
+  ReadPageGuard guard = FindLeafPageRead(key);
+  if (!guard) {
+    return false;
   }
-  return ret;
+  auto *leaf = guard.As<BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>>();
+  ValueType value;
+  if (leaf->Lookup(key, value, comparator_)) {
+    result.push_back(value);
+    return true;
+  }
+  return false;
 }
 
 /*****************************************************************************
@@ -109,20 +99,20 @@ Insert(const KeyType &key, const ValueType &value, Transaction *transaction) {
 template <typename KeyType, typename ValueType, typename KeyComparator>
 void BPlusTree<KeyType, ValueType, KeyComparator>::
 StartNewTree(const KeyType &key, const ValueType &value) {
-  auto *page = buffer_pool_manager_->NewPage(root_page_id_);
-  if (page == nullptr) {
+  page_id_t root_page_id;
+  PageGuard guard = buffer_pool_manager_->NewPageGuarded(root_page_id);
+  if (!guard) {
     throw Exception(EXCEPTION_TYPE_INDEX,
                     "all page are pinned while StartNewTree");
   }
-  auto root =
-      reinterpret_cast<BPlusTreeLeafPage<KeyType, ValueType,
-                                         KeyComparator> *>(page->GetData());
-  UpdateRootPageId(true);
-  root->Init(root_page_id_, INVALID_PAGE_ID);
+  auto root = guard.As<BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>>();
+  guard.GetPage()->WLatch();
+  root->Init(root_page_id, buffer_pool_manager_->GetPageSize());
   root->Insert(key, value, comparator_);
-
-  // unpin root
-  buffer_pool_manager_->UnpinPage(root->GetPageId(), true);
+  guard.GetPage()->WUnlatch();
+  guard.SetDirty();
+  root_page_id_.store(root_page_id, std::memory_order_release);
+  UpdateRootPageId(true);
 }
 
 /*
@@ -195,13 +185,14 @@ template <typename KeyType, typename ValueType, typename KeyComparator>
 template <typename N> N *BPlusTree<KeyType, ValueType, KeyComparator>::
 Split(N *node) {
   page_id_t page_id;
-  auto *page = buffer_pool_manager_->NewPage(page_id);
+  // siblings next to each other keep range scans sequential on disk
+  auto *page = buffer_pool_manager_->NewPage(page_id, node->GetPageId());
   if (page == nullptr) {
     throw Exception(EXCEPTION_TYPE_INDEX,
                     "all page are pinned while Split");
   }
   auto new_node = reinterpret_cast<N *>(page->GetData());
-  new_node->Init(page_id);
+  new_node->Init(page_id, buffer_pool_manager_->GetPageSize());
 
   node->MoveHalfTo(new_node, buffer_pool_manager_);
   return new_node;
@@ -221,38 +212,41 @@ void BPlusTree<KeyType, ValueType, KeyComparator>::
 InsertIntoParent(BPlusTreePage *old_node, const KeyType &key,
                  BPlusTreePage *new_node, Transaction *transaction) {
   if (old_node->IsRootPage()) {
-    auto *page = buffer_pool_manager_->NewPage(root_page_id_);
-    if (page == nullptr) {
+    page_id_t root_page_id;
+    PageGuard guard = buffer_pool_manager_->NewPageGuarded(root_page_id);
+    if (!guard) {
       throw Exception(EXCEPTION_TYPE_INDEX,
                       "all page are pinned while InsertIntoParent");
     }
-    assert(page->GetPinCount() == 1);
-    auto root =
-        reinterpret_cast<BPlusTreeInternalPage<KeyType, page_id_t,
-                                               KeyComparator> *>(page->GetData());
-    root->Init(root_page_id_);
+    assert(guard.GetPage()->GetPinCount() == 1);
+    auto root = guard.As<
+        BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator>>();
+    guard.SetDirty();
+    guard.GetPage()->WLatch();
+    root->Init(root_page_id, buffer_pool_manager_->GetPageSize());
     root->PopulateNewRoot(old_node->GetPageId(), key, new_node->GetPageId());
+    guard.GetPage()->WUnlatch();
 
-    old_node->SetParentPageId(root_page_id_);
-    new_node->SetParentPageId(root_page_id_);
+    // both are write latched by the caller, an optimistic reader that
+    // still finds the old root sees it is not the root anymore and retries
+    old_node->SetParentPageId(root_page_id);
+    new_node->SetParentPageId(root_page_id);
 
-    // update to new 'root_page_id'
+    // update to new 'root_page_id' once the page is complete
+    root_page_id_.store(root_page_id, std::memory_order_release);
     UpdateRootPageId(false);
 
     buffer_pool_manager_->UnpinPage(new_node->GetPageId(), true);
-
-    // parent is done
-    buffer_pool_manager_->UnpinPage(root->GetPageId(), true);
-
   } else {
-    auto *page = buffer_pool_manager_->FetchPage(old_node->GetParentPageId());
-    if (page == nullptr) {
+    PageGuard guard =
+        buffer_pool_manager_->FetchPageGuarded(old_node->GetParentPageId());
+    if (!guard) {
       throw Exception(EXCEPTION_TYPE_INDEX,
                       "all page are pinned while InsertIntoParent");
     }
-    auto internal =
-        reinterpret_cast<BPlusTreeInternalPage<KeyType, page_id_t,
-                                               KeyComparator> *>(page->GetData());
+    auto internal = guard.As<
+        BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator>>();
+    guard.SetDirty();
     // internal node have space to take new pair
     if (internal->GetSize() < internal->GetMaxSize()) {
       internal->InsertNodeAfter(old_node->GetPageId(), key, new_node->GetPageId());
@@ -265,19 +259,18 @@ InsertIntoParent(BPlusTreePage *old_node, const KeyType &key,
       // internal have no space and have to split
       // first make a copy of internal node, simplify split process
       page_id_t page_id;
-      auto *page = buffer_pool_manager_->NewPage(page_id);
-      if (page == nullptr) {
+      PageGuard copy_guard = buffer_pool_manager_->NewPageGuarded(page_id);
+      if (!copy_guard) {
         throw Exception(EXCEPTION_TYPE_INDEX,
                         "all page are pinned while InsertIntoParent");
       }
-      assert(page->GetPinCount() == 1);
+      assert(copy_guard.GetPage()->GetPinCount() == 1);
 
       // copy will contain all internal node's pair excluding the first one
       // and plus the new one [key,value] which must be at the right position
-      auto *copy =
-          reinterpret_cast<BPlusTreeInternalPage<KeyType, page_id_t,
-                                                 KeyComparator> *>(page->GetData());
-      copy->Init(page_id);
+      auto *copy = copy_guard.As<
+          BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator>>();
+      copy->Init(page_id, buffer_pool_manager_->GetPageSize());
       copy->SetSize(internal->GetSize());
       for (int i = 1, j = 0; i <= internal->GetSize(); ++i, ++j) {
         if (internal->ValueAt(i - 1) == old_node->GetPageId()) {
@@ -319,14 +312,12 @@ InsertIntoParent(BPlusTreePage *old_node, const KeyType &key,
       buffer_pool_manager_->UnpinPage(new_node->GetPageId(), true);
 
       // delete copy
-      buffer_pool_manager_->UnpinPage(copy->GetPageId(), false);
-      buffer_pool_manager_->DeletePage(copy->GetPageId());
+      copy_guard.Release();
+      buffer_pool_manager_->DeletePage(page_id);
 
       // recursive call until root if necessary
       InsertIntoParent(internal, internal2->KeyAt(0), internal2);
     }
-
-    buffer_pool_manager_->UnpinPage(internal->GetPageId(), true);
   }
 }
 
@@ -396,15 +387,16 @@ CoalesceOrRedistribute(N *node, Transaction *transaction) {
   }
 
   // get parent first
-  auto *page = buffer_pool_manager_->FetchPage(node->GetParentPageId());
-  if (page == nullptr) {
+  PageGuard parent_guard =
+      buffer_pool_manager_->FetchPageGuarded(node->GetParentPageId());
+  if (!parent_guard) {
     throw Exception(EXCEPTION_TYPE_INDEX,
                     "all page are pinned while CoalesceOrRedistribute");
   }
+  parent_guard.SetDirty();
   // find sibling first, always find the previous one if possible
-  auto parent =
-      reinterpret_cast<BPlusTreeInternalPage<KeyType, page_id_t,
-                                             KeyComparator> *>(page->GetData());
+  auto parent = parent_guard.As<
+      BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator>>();
   // sibling should has the same parent with node
   int value_index = parent->ValueIndex(node->GetPageId());
 
@@ -419,7 +411,7 @@ CoalesceOrRedistribute(N *node, Transaction *transaction) {
   }
 
   // fetch sibling node
-  page = buffer_pool_manager_->FetchPage(sibling_page_id);
+  auto *page = buffer_pool_manager_->FetchPage(sibling_page_id);
   if (page == nullptr) {
     throw Exception(EXCEPTION_TYPE_INDEX,
                     "all page are pinned while CoalesceOrRedistribute");
@@ -439,7 +431,7 @@ CoalesceOrRedistribute(N *node, Transaction *transaction) {
   if (sibling->GetSize() + node->GetSize() > node->GetMaxSize()) {
     redistribute = true;
     // release parent
-    buffer_pool_manager_->UnpinPage(parent->GetPageId(), true);
+    parent_guard.Release();
   }
 
   // redistribute key-value pairs
@@ -466,8 +458,6 @@ CoalesceOrRedistribute(N *node, Transaction *transaction) {
     // node should be deleted
     ret = true;
   }
-  // release parent
-  buffer_pool_manager_->UnpinPage(parent->GetPageId(), true);
   return ret;
 }
 
@@ -518,16 +508,16 @@ Redistribute(N *neighbor_node, N *node, int index) {
   if (index == 0) {
     neighbor_node->MoveFirstToEndOf(node, buffer_pool_manager_);
   } else {
-    auto *page = buffer_pool_manager_->FetchPage(node->GetParentPageId());
-    if (page == nullptr) {
+    PageGuard guard =
+        buffer_pool_manager_->FetchPageGuarded(node->GetParentPageId());
+    if (!guard) {
       throw Exception(EXCEPTION_TYPE_INDEX,
                       "all page are pinned while Redistribute");
     }
-    auto parent =
-        reinterpret_cast<BPlusTreeInternalPage<KeyType, page_id_t,
-                                               KeyComparator> *>(page->GetData());
+    auto parent = guard.As<
+        BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator>>();
     int idx = parent->ValueIndex(node->GetPageId());
-    buffer_pool_manager_->UnpinPage(parent->GetPageId(), false);
+    guard.Release();
 
     neighbor_node->MoveLastToFrontOf(node, idx, buffer_pool_manager_);
   }
@@ -565,16 +555,13 @@ AdjustRoot(BPlusTreePage *old_root_node) {
     UpdateRootPageId(false);
 
     // set the new root's parent id "INVALID_PAGE_ID"
-    auto *page = buffer_pool_manager_->FetchPage(root_page_id_);
-    if (page == nullptr) {
+    PageGuard guard = buffer_pool_manager_->FetchPageGuarded(root_page_id_);
+    if (!guard) {
       throw Exception(EXCEPTION_TYPE_INDEX,
                       "all page are pinned while AdjustRoot");
     }
-    auto new_root =
-        reinterpret_cast<BPlusTreeInternalPage<KeyType, page_id_t,
-                                               KeyComparator> *>(page->GetData());
-    new_root->SetParentPageId(INVALID_PAGE_ID);
-    buffer_pool_manager_->UnpinPage(root_page_id_, true);
+    guard.As<BPlusTreePage>()->SetParentPageId(INVALID_PAGE_ID);
+    guard.SetDirty();
     return true;
   }
   return false;
@@ -593,7 +580,7 @@ IndexIterator<KeyType, ValueType, KeyComparator> BPlusTree<KeyType, ValueType, K
 Begin() {
   KeyType key{};
   return IndexIterator<KeyType, ValueType, KeyComparator>(
-      FindLeafPage(key, true), 0, buffer_pool_manager_);
+      FindLeafPageRead(key, true), 0, buffer_pool_manager_);
 }
 
 /*
@@ -604,13 +591,14 @@ Begin() {
 template <typename KeyType, typename ValueType, typename KeyComparator>
 IndexIterator<KeyType, ValueType, KeyComparator> BPlusTree<KeyType, ValueType, KeyComparator>::
 Begin(const KeyType &key) {
-  auto *leaf = FindLeafPage(key, false);
+  ReadPageGuard guard = FindLeafPageRead(key);
   int index = 0;
-  if (leaf != nullptr) {
-    index = leaf->KeyIndex(key, comparator_);
+  if (guard) {
+    index = guard.As<BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>>()
+                ->KeyIndex(key, comparator_);
   }
   return IndexIterator<KeyType, ValueType, KeyComparator>(
-      leaf, index, buffer_pool_manager_);
+      std::move(guard), index, buffer_pool_manager_);
 }
 
 /*****************************************************************************
@@ -761,6 +749,123 @@ FindLeafPage(const KeyType &key, bool leftMost, Operation op, Transaction *trans
                                             ValueType, KeyComparator> *>(node);
 }
 
+/*
+ * Read only descent, the guard of the leaf is handed to the caller. Inner
+ * nodes are read optimistically so readers do not write to their latches,
+ * after OPTIMISTIC_READ_RETRIES failed attempts fall back to latch crabbing
+ */
+template <typename KeyType, typename ValueType, typename KeyComparator>
+ReadPageGuard BPlusTree<KeyType, ValueType, KeyComparator>::
+FindLeafPageRead(const KeyType &key, bool leftMost) {
+  for (int attempt = 0; attempt < OPTIMISTIC_READ_RETRIES; ++attempt) {
+    ReadPageGuard leaf;
+    if (FindLeafPageOptimistic(key, leftMost, leaf)) {
+      return leaf;
+    }
+  }
+  return FindLeafPageCrabbing(key, leftMost);
+}
+
+/*
+ * Optimistic lock coupling: pin the child, sample its version, then validate
+ * the parent, which proves the child pointer was still current. Only the
+ * leaf is read latched, and only if its version did not move meanwhile.
+ * Inner pages may be read while a writer changes them, everything read is
+ * checked or validated before it is used to go further down
+ */
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool BPlusTree<KeyType, ValueType, KeyComparator>::
+FindLeafPageOptimistic(const KeyType &key, bool leftMost,
+                       ReadPageGuard &leaf) {
+  page_id_t root_page_id = root_page_id_.load(std::memory_order_acquire);
+  if (root_page_id == INVALID_PAGE_ID) {
+    return true;
+  }
+  PageGuard guard = buffer_pool_manager_->FetchPageGuarded(root_page_id);
+  if (!guard) {
+    throw Exception(EXCEPTION_TYPE_INDEX,
+                    "all page are pinned while FindLeafPage");
+  }
+  uint64_t version = guard.GetPage()->ReadVersion();
+  auto *node = guard.As<BPlusTreePage>();
+  // the root was split or collapsed after root_page_id_ was read
+  if (!node->IsRootPage()) {
+    return false;
+  }
+
+  while (!node->IsLeafPage()) {
+    auto internal =
+        reinterpret_cast<BPlusTreeInternalPage<KeyType, page_id_t,
+                                               KeyComparator> *>(node);
+    // a torn size would send Lookup outside of the page
+    if (internal->GetSize() <= 0 ||
+        internal->GetSize() > internal->GetMaxSize()) {
+      return false;
+    }
+    page_id_t child_page_id = leftMost ? internal->ValueAt(0)
+                                       : internal->Lookup(key, comparator_);
+    if (!guard.GetPage()->ValidateVersion(version)) {
+      return false;
+    }
+    PageGuard child = buffer_pool_manager_->FetchPageGuarded(child_page_id);
+    if (!child) {
+      throw Exception(EXCEPTION_TYPE_INDEX,
+                      "all page are pinned while FindLeafPage");
+    }
+    uint64_t child_version = child.GetPage()->ReadVersion();
+    if (!guard.GetPage()->ValidateVersion(version)) {
+      return false;
+    }
+    guard = std::move(child);
+    version = child_version;
+    node = guard.As<BPlusTreePage>();
+  }
+
+  Page *page = guard.GetPage();
+  page->RLatch();
+  if (!page->ValidateVersion(version)) {
+    page->RUnlatch();
+    return false;
+  }
+  leaf = ReadPageGuard(std::move(guard));
+  return true;
+}
+
+/*
+ * Read only descent with latch crabbing, a child is latched before its
+ * parent is released
+ */
+template <typename KeyType, typename ValueType, typename KeyComparator>
+ReadPageGuard BPlusTree<KeyType, ValueType, KeyComparator>::
+FindLeafPageCrabbing(const KeyType &key, bool leftMost) {
+  if (IsEmpty()) {
+    return ReadPageGuard();
+  }
+  ReadPageGuard guard = buffer_pool_manager_->FetchPageRead(root_page_id_);
+  if (!guard) {
+    throw Exception(EXCEPTION_TYPE_INDEX,
+                    "all page are pinned while FindLeafPage");
+  }
+
+  auto *node = guard.As<BPlusTreePage>();
+  while (!node->IsLeafPage()) {
+    auto internal =
+        reinterpret_cast<BPlusTreeInternalPage<KeyType, page_id_t,
+                                               KeyComparator> *>(node);
+    page_id_t child_page_id = leftMost ? internal->ValueAt(0)
+                                       : internal->Lookup(key, comparator_);
+    ReadPageGuard child = buffer_pool_manager_->FetchPageRead(child_page_id);
+    if (!child) {
+      throw Exception(EXCEPTION_TYPE_INDEX,
+                      "all page are pinned while FindLeafPage");
+    }
+    assert(child.As<BPlusTreePage>()->GetParentPageId() == node->GetPageId());
+    guard = std::move(child);
+    node = guard.As<BPlusTreePage>();
+  }
+  return guard;
+}
+
 /*
  * Update/Insert root page id in header page(where page_id = 0, header_page is
  * defined under include/page/header_page.h)
@@ -772,12 +877,13 @@ FindLeafPage(const KeyType &key, bool leftMost, Operation op, Transaction *trans
 template <typename KeyType, typename ValueType, typename KeyComparator>
 void BPlusTree<KeyType, ValueType, KeyComparator>::
 UpdateRootPageId(bool insert_record) {
-  auto *page = buffer_pool_manager_->FetchPage(HEADER_PAGE_ID);
-  if (page == nullptr) {
+  PageGuard guard = buffer_pool_manager_->FetchPageGuarded(HEADER_PAGE_ID);
+  if (!guard) {
     throw Exception(EXCEPTION_TYPE_INDEX,
                     "all page are pinned while UpdateRootPageId");
   }
-  auto *header_page = reinterpret_cast<HeaderPage *>(page->GetData());
+  auto *header_page = static_cast<HeaderPage *>(guard.GetPage());
+  guard.SetDirty();
 
   if (insert_record) {
     // create a new record<index_name + root_page_id> in header_page
@@ -786,7 +892,6 @@ UpdateRootPageId(bool insert_record) {
     // update root_page_id in header_page
     header_page->UpdateRecord(index_name_, root_page_id_);
   }
-  buffer_pool_manager_->UnpinPage(HEADER_PAGE_ID, true);
 }
 
 /*
@@ -1,7 +1,9 @@
 /**
  * index_iterator.cpp
  */
+#include <algorithm>
 #include <cassert>
+#include <utility>
 
 #include "index/index_iterator.h"
 
@@ -13,17 +15,14 @@ namespace cmudb {
  */
 template <typename KeyType, typename ValueType, typename KeyComparator>
 IndexIterator<KeyType, ValueType, KeyComparator>::
-IndexIterator(BPlusTreeLeafPage<KeyType, ValueType, KeyComparator> *leaf,
-              int index_, BufferPoolManager *buff_pool_manager):
-    leaf_(leaf), index_(index_), buff_pool_manager_(buff_pool_manager) {}
-
-template <typename KeyType, typename ValueType, typename KeyComparator>
-IndexIterator<KeyType, ValueType, KeyComparator>::
-~IndexIterator() {
-  buff_pool_manager_->FetchPage(leaf_->GetPageId())->RUnlatch();
-  buff_pool_manager_->UnpinPage(leaf_->GetPageId(), false);
-  buff_pool_manager_->UnpinPage(leaf_->GetPageId(), false);
-};
+IndexIterator(ReadPageGuard &&leaf, int index,
+              BufferPoolManager *buff_pool_manager):
+    guard_(std::move(leaf)), leaf_(nullptr), index_(index),
+    buff_pool_manager_(buff_pool_manager), read_ahead_end_(INVALID_PAGE_ID) {
+  if (guard_) {
+    leaf_ = guard_.As<BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>>();
+  }
+}
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 bool IndexIterator<KeyType, ValueType, KeyComparator>::
@@ -48,29 +47,47 @@ operator++() {
   if (index_ == leaf_->GetSize() && leaf_->GetNextPageId() != INVALID_PAGE_ID) {
     // first unpin leaf_, then get the next leaf
     page_id_t next_page_id = leaf_->GetNextPageId();
+    page_id_t prev_page_id = leaf_->GetPageId();
 
-    auto *page = buff_pool_manager_->FetchPage(next_page_id);
-    if (page == nullptr) {
+    auto next = buff_pool_manager_->FetchPageRead(next_page_id);
+    if (!next) {
       throw Exception(EXCEPTION_TYPE_INDEX,
                       "all page are pinned while IndexIterator(operator++)");
     }
     // first acquire next page, then release previous page
-    page->RLatch();
-
-    buff_pool_manager_->FetchPage(leaf_->GetPageId())->RUnlatch();
-    buff_pool_manager_->UnpinPage(leaf_->GetPageId(), false);
-    buff_pool_manager_->UnpinPage(leaf_->GetPageId(), false);
-
-    auto next_leaf =
-        reinterpret_cast<BPlusTreeLeafPage<KeyType, ValueType,
-                                           KeyComparator> *>(page->GetData());
-    assert(next_leaf->IsLeafPage());
+    guard_ = std::move(next);
+    leaf_ = guard_.As<BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>>();
+    assert(leaf_->IsLeafPage());
     index_ = 0;
-    leaf_ = next_leaf;
+    ReadAhead(prev_page_id);
   }
   return *this;
 };
 
+/*
+ * helper function to prefetch the leaves following leaf_
+ */
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void IndexIterator<KeyType, ValueType, KeyComparator>::
+ReadAhead(page_id_t prev_page_id) {
+  page_id_t next_page_id = leaf_->GetNextPageId();
+  if (next_page_id == INVALID_PAGE_ID) {
+    return;
+  }
+  if (leaf_->GetPageId() != prev_page_id + 1 ||
+      next_page_id != leaf_->GetPageId() + 1) {
+    buff_pool_manager_->Prefetch(next_page_id);
+    return;
+  }
+  // sequential, refill the window once half of it has been consumed
+  if (next_page_id + READ_AHEAD_PAGES / 2 < read_ahead_end_) {
+    return;
+  }
+  page_id_t start = std::max(next_page_id, read_ahead_end_);
+  read_ahead_end_ = next_page_id + READ_AHEAD_PAGES;
+  buff_pool_manager_->Prefetch(start, read_ahead_end_ - start);
+}
+
 template class IndexIterator<GenericKey<4>, RID, GenericComparator<4>>;
 template class IndexIterator<GenericKey<8>, RID, GenericComparator<8>>;
 template class IndexIterator<GenericKey<16>, RID, GenericComparator<16>>;
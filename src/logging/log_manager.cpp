@@ -2,6 +2,9 @@
  * log_manager.cpp
  */
 
+#include <cassert>
+#include <cstring>
+
 #include "logging/log_manager.h"
 
 namespace cmudb {
@@ -12,11 +15,57 @@ namespace cmudb {
  * manager wants to force flush (it only happens when the flushed page has a
  * larger LSN than persistent LSN)
  */
-void LogManager::RunFlushThread() {}
+void LogManager::RunFlushThread() {
+  std::lock_guard<std::mutex> lock(latch_);
+  if (flush_thread_ != nullptr) {
+    return;
+  }
+  ENABLE_LOGGING = true;
+  flush_thread_ = new std::thread(&LogManager::FlushThread, this);
+}
 /*
  * Stop and join the flush thread, set ENABLE_LOGGING = false
  */
-void LogManager::StopFlushThread() {}
+void LogManager::StopFlushThread() {
+  std::thread *flush_thread;
+  {
+    std::lock_guard<std::mutex> lock(latch_);
+    ENABLE_LOGGING = false;
+    flush_thread = flush_thread_;
+    flush_thread_ = nullptr;
+  }
+  cv_.notify_one();
+  if (flush_thread != nullptr) {
+    flush_thread->join();
+    delete flush_thread;
+  }
+}
+
+/*
+ * Every LOG_TIMEOUT, or right away when asked for it, swap the log buffer
+ * with the flush buffer and write the records out without the latch, so
+ * appends go on meanwhile. A last flush is made once logging is turned off
+ */
+void LogManager::FlushThread() {
+  std::unique_lock<std::mutex> lock(latch_);
+  bool running = true;
+  while (running) {
+    cv_.wait_for(lock, LOG_TIMEOUT,
+                 [this] { return flush_requested_ || !ENABLE_LOGGING; });
+    running = ENABLE_LOGGING;
+    flush_requested_ = false;
+    std::swap(log_buffer_, flush_buffer_);
+    int size = offset_;
+    lsn_t lsn = next_lsn_ - 1;
+    offset_ = 0;
+    lock.unlock();
+    // appenders waiting for room can go on
+    append_cv_.notify_all();
+    disk_manager_->WriteLog(flush_buffer_, size);
+    SetPersistentLSN(lsn);
+    lock.lock();
+  }
+}
 
 /*
  * append a log record into log buffer
@@ -39,8 +88,75 @@ void LogManager::StopFlushThread() {}
  *
  */
 lsn_t LogManager::AppendLogRecord(LogRecord &log_record) {
+  assert(log_record.size_ <= LOG_BUFFER_SIZE);
+  std::unique_lock<std::mutex> lock(latch_);
+  // a full buffer is flushed first
+  while (offset_ + log_record.size_ > LOG_BUFFER_SIZE) {
+    flush_requested_ = true;
+    cv_.notify_one();
+    append_cv_.wait(lock);
+  }
 
-  return INVALID_LSN;
+  log_record.lsn_ = next_lsn_++;
+  char *pos = log_buffer_ + offset_;
+  memcpy(pos, &log_record, LogRecord::HEADER_SIZE);
+  pos += LogRecord::HEADER_SIZE;
+  switch (log_record.log_record_type_) {
+  case LogRecordType::INSERT:
+    memcpy(pos, &log_record.insert_rid_, sizeof(RID));
+    log_record.insert_tuple_.SerializeTo(pos + sizeof(RID));
+    break;
+  case LogRecordType::MARKDELETE:
+  case LogRecordType::APPLYDELETE:
+  case LogRecordType::ROLLBACKDELETE:
+    memcpy(pos, &log_record.delete_rid_, sizeof(RID));
+    log_record.delete_tuple_.SerializeTo(pos + sizeof(RID));
+    break;
+  case LogRecordType::UPDATE:
+    memcpy(pos, &log_record.update_rid_, sizeof(RID));
+    pos += sizeof(RID);
+    log_record.old_tuple_.SerializeTo(pos);
+    pos += sizeof(int32_t) + log_record.old_tuple_.GetLength();
+    log_record.new_tuple_.SerializeTo(pos);
+    break;
+  case LogRecordType::NEWPAGE:
+    memcpy(pos, &log_record.prev_page_id_, sizeof(page_id_t));
+    break;
+  default:
+    break;
+  }
+  offset_ += log_record.size_;
+  return log_record.lsn_;
+}
+
+/*
+ * Used by the buffer pool before it writes back a page whose LSN is larger
+ * than the persistent LSN. The caller must not hold any latch the flush
+ * thread needs. The flush request is repeated every LOG_TIMEOUT in case the
+ * flush thread missed it
+ */
+void LogManager::WaitUntilPersistent(lsn_t lsn) {
+  std::unique_lock<std::mutex> lock(persistent_latch_);
+  while (ENABLE_LOGGING && persistent_lsn_ < lsn) {
+    {
+      std::lock_guard<std::mutex> flush_lock(latch_);
+      flush_requested_ = true;
+    }
+    cv_.notify_one();
+    persistent_cv_.wait_for(lock, LOG_TIMEOUT);
+  }
+}
+
+/*
+ * Called by the flush thread once log records up to lsn are on disk, wakes
+ * up the threads waiting for them
+ */
+void LogManager::SetPersistentLSN(lsn_t lsn) {
+  {
+    std::lock_guard<std::mutex> lock(persistent_latch_);
+    persistent_lsn_ = lsn;
+  }
+  persistent_cv_.notify_all();
 }
 
 } // namespace cmudb
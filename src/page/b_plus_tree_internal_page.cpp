@@ -18,7 +18,7 @@ namespace cmudb {
  */
 template <typename KeyType, typename ValueType, typename KeyComparator>
 void BPlusTreeInternalPage<KeyType, ValueType, KeyComparator>::
-Init(page_id_t page_id, page_id_t parent_id) {
+Init(page_id_t page_id, size_t page_size, page_id_t parent_id) {
   // set page type
   SetPageType(IndexPageType::INTERNAL_PAGE);
   // set current size: 1 for the first invalid key
@@ -29,7 +29,7 @@ Init(page_id_t page_id, page_id_t parent_id) {
   SetParentPageId(parent_id);
 
   // set max page size, header is 24bytes
-  int size = (PAGE_SIZE - sizeof(BPlusTreeInternalPage))/
+  int size = (page_size - sizeof(BPlusTreeInternalPage))/
       (sizeof(KeyType) + sizeof(ValueType));
   SetMaxSize(size);
 }
@@ -2,14 +2,18 @@
  * table_iterator.cpp
  */
 
+#include <algorithm>
 #include <cassert>
+#include <utility>
 
 #include "table/table_heap.h"
 
 namespace cmudb {
 
-TableIterator::TableIterator(TableHeap *table_heap, RID rid, Transaction *txn)
-    : table_heap_(table_heap), tuple_(new Tuple(rid)), txn_(txn) {
+TableIterator::TableIterator(TableHeap *table_heap, RID rid, Transaction *txn,
+                             std::shared_ptr<BufferAccessStrategy> strategy)
+    : table_heap_(table_heap), tuple_(new Tuple(rid)), txn_(txn),
+      read_ahead_end_(INVALID_PAGE_ID), strategy_(std::move(strategy)) {
   if (rid.GetPageId() != INVALID_PAGE_ID) {
     table_heap_->GetTuple(tuple_->rid_, *tuple_, txn_);
   }
@@ -27,36 +31,58 @@ Tuple *TableIterator::operator->() {
 
 TableIterator &TableIterator::operator++() {
   BufferPoolManager *buffer_pool_manager = table_heap_->buffer_pool_manager_;
-  auto cur_page = static_cast<TablePage *>(
-      buffer_pool_manager->FetchPage(tuple_->rid_.GetPageId()));
-  cur_page->RLatch();
-  assert(cur_page != nullptr); // all pages are pinned
+  auto guard = buffer_pool_manager->FetchPageRead(tuple_->rid_.GetPageId(),
+                                                  strategy_.get());
+  assert(guard); // all pages are pinned
+  auto cur_page = static_cast<TablePage *>(guard.GetPage());
 
   RID next_tuple_rid;
   if (!cur_page->GetNextTupleRid(tuple_->rid_,
                                  next_tuple_rid)) { // end of this page
     while (cur_page->GetNextPageId() != INVALID_PAGE_ID) {
-      auto next_page = static_cast<TablePage *>(
-          buffer_pool_manager->FetchPage(cur_page->GetNextPageId()));
-      cur_page->RUnlatch();
-      buffer_pool_manager->UnpinPage(cur_page->GetPageId(), false);
-      cur_page = next_page;
-      cur_page->RLatch();
+      auto next = buffer_pool_manager->FetchPageRead(
+          cur_page->GetNextPageId(), strategy_.get());
+      assert(next);
+      page_id_t prev_page_id = cur_page->GetPageId();
+      guard = std::move(next);
+      cur_page = static_cast<TablePage *>(guard.GetPage());
+      ReadAhead(prev_page_id, cur_page);
       if (cur_page->GetFirstTupleRid(next_tuple_rid))
         break;
     }
   }
   tuple_->rid_ = next_tuple_rid;
 
+  // copy the tuple from the page still latched
   if (*this != table_heap_->end()) {
-    table_heap_->GetTuple(tuple_->rid_, *tuple_, txn_);
+    cur_page->GetTuple(tuple_->rid_, *tuple_, txn_, table_heap_->lock_manager_);
   }
-  // release until copy the tuple
-  cur_page->RUnlatch();
-  buffer_pool_manager->UnpinPage(cur_page->GetPageId(), false);
   return *this;
 }
 
+/*
+ * helper function to prefetch the pages following page
+ */
+void TableIterator::ReadAhead(page_id_t prev_page_id, TablePage *page) {
+  page_id_t next_page_id = page->GetNextPageId();
+  if (next_page_id == INVALID_PAGE_ID) {
+    return;
+  }
+  BufferPoolManager *buffer_pool_manager = table_heap_->buffer_pool_manager_;
+  if (page->GetPageId() != prev_page_id + 1 ||
+      next_page_id != page->GetPageId() + 1) {
+    buffer_pool_manager->Prefetch(next_page_id, 1, strategy_);
+    return;
+  }
+  // sequential, refill the window once half of it has been consumed
+  if (next_page_id + READ_AHEAD_PAGES / 2 < read_ahead_end_) {
+    return;
+  }
+  page_id_t start = std::max(next_page_id, read_ahead_end_);
+  read_ahead_end_ = next_page_id + READ_AHEAD_PAGES;
+  buffer_pool_manager->Prefetch(start, read_ahead_end_ - start, strategy_);
+}
+
 TableIterator TableIterator::operator++(int) {
   TableIterator clone(*this);
   ++(*this);
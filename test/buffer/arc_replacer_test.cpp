@@ -0,0 +1,117 @@
+/**
+ * arc_replacer_test.cpp
+ */
+
+#include <cstdio>
+#include <unordered_set>
+#include <vector>
+
+#include "buffer/arc_replacer.h"
+#include "gtest/gtest.h"
+
+namespace cmudb {
+
+TEST(ARCReplacerTest, SampleTest) {
+  ARCReplacer<int> arc_replacer(4);
+
+  // 1 and 2 are accessed twice and move to T2
+  arc_replacer.Insert(1);
+  arc_replacer.Insert(2);
+  arc_replacer.Insert(3);
+  arc_replacer.Insert(4);
+  arc_replacer.Insert(1);
+  arc_replacer.Insert(2);
+  EXPECT_EQ(4, arc_replacer.Size());
+  EXPECT_EQ(0, arc_replacer.GetAdaptiveTarget());
+
+  // T1 is above its target
+  int value;
+  arc_replacer.Victim(value);
+  EXPECT_EQ(3, value);
+  EXPECT_EQ(1, arc_replacer.GetGhostSize());
+
+  // pinned pages are skipped
+  EXPECT_EQ(true, arc_replacer.Erase(4));
+  EXPECT_EQ(false, arc_replacer.Erase(4));
+  arc_replacer.Victim(value);
+  EXPECT_EQ(1, value);
+  EXPECT_EQ(2, arc_replacer.GetGhostSize());
+
+  // a miss on a page that was evicted from T1 grows the target of T1 and
+  // brings the page back on T2
+  arc_replacer.Insert(3);
+  EXPECT_EQ(1, arc_replacer.GetAdaptiveTarget());
+  EXPECT_EQ(1, arc_replacer.GetGhostSize());
+
+  // a miss on a page that was evicted from T2 shrinks it again
+  arc_replacer.Insert(1);
+  EXPECT_EQ(0, arc_replacer.GetAdaptiveTarget());
+  EXPECT_EQ(0, arc_replacer.GetGhostSize());
+  EXPECT_EQ(3, arc_replacer.Size());
+
+  // everything is on T2 now
+  arc_replacer.Insert(4);
+  arc_replacer.Victim(value);
+  EXPECT_EQ(2, value);
+  arc_replacer.Victim(value);
+  EXPECT_EQ(3, value);
+  arc_replacer.Victim(value);
+  EXPECT_EQ(1, value);
+  arc_replacer.Victim(value);
+  EXPECT_EQ(4, value);
+  EXPECT_EQ(false, arc_replacer.Victim(value));
+}
+
+TEST(ARCReplacerTest, AdaptTest) {
+  const size_t num_frames = 32;
+  ARCReplacer<int> arc_replacer(num_frames);
+  std::unordered_set<int> resident;
+  size_t hits = 0;
+  auto access = [&](int page_id) {
+    if (resident.count(page_id) > 0) {
+      ++hits;
+      arc_replacer.Erase(page_id);
+    } else {
+      if (resident.size() == num_frames) {
+        int victim;
+        EXPECT_EQ(true, arc_replacer.Victim(victim));
+        resident.erase(victim);
+      }
+      resident.insert(page_id);
+    }
+    arc_replacer.Insert(page_id);
+  };
+
+  // point query burst over a hot set, interleaved with a scan
+  for (int i = 0; i < 10000; ++i) {
+    access(1000 + i % 12);
+    access(100000 + i);
+  }
+  size_t after_burst = arc_replacer.GetAdaptiveTarget();
+
+  // nightly full scan, the hot set stays on T2 while the scan cycles
+  // through T1
+  for (int i = 0; i < 10000; ++i) {
+    access(200000 + i);
+  }
+  hits = 0;
+  for (int i = 0; i < 12; ++i) {
+    access(1000 + i);
+  }
+  EXPECT_EQ(12, hits);
+
+  // a short scan loop does not fit in what is left for T1, its pages come
+  // back while still on B1 and T1 is given more room
+  for (int round = 0; round < 8; ++round) {
+    for (int i = 0; i < 28; ++i) {
+      access(300000 + i);
+    }
+  }
+  size_t after_rescan = arc_replacer.GetAdaptiveTarget();
+  printf("target of T1: %zu after point queries, %zu after repeated scans\n",
+         after_burst, after_rescan);
+  EXPECT_GT(after_rescan, after_burst);
+  EXPECT_LE(after_rescan, num_frames);
+}
+
+} // namespace cmudb
@@ -2,9 +2,15 @@
  * buffer_pool_manager_test.cpp
  */
 
+#include <atomic>
+#include <chrono>
 #include <cstdio>
+#include <cstring>
+#include <thread>
+#include <vector>
 
 #include "buffer/buffer_pool_manager.h"
+#include "common/exception.h"
 #include "gtest/gtest.h"
 
 namespace cmudb {
@@ -48,4 +54,878 @@ TEST(BufferPoolManagerTest, SampleTest) {
   remove("test.db");
 }
 
+TEST(BufferPoolManagerTest, ClockTest) {
+  page_id_t temp_page_id;
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  {
+    BufferPoolManager bpm(10, disk_manager, nullptr, 1, ReplacerPolicy::CLOCK);
+
+    auto page_zero = bpm.NewPage(temp_page_id);
+    ASSERT_NE(nullptr, page_zero);
+    strcpy(page_zero->GetData(), "Hello");
+    for (int i = 1; i < 10; ++i) {
+      EXPECT_NE(nullptr, bpm.NewPage(temp_page_id));
+    }
+    EXPECT_EQ(nullptr, bpm.NewPage(temp_page_id));
+
+    // only the first five pages can be evicted
+    for (int i = 0; i < 5; ++i) {
+      EXPECT_EQ(true, bpm.UnpinPage(i, true));
+    }
+    page_id_t last_page_id = INVALID_PAGE_ID;
+    for (int i = 0; i < 5; ++i) {
+      EXPECT_NE(nullptr, bpm.NewPage(last_page_id));
+    }
+    EXPECT_EQ(nullptr, bpm.NewPage(temp_page_id));
+
+    // page zero was written back when it was evicted
+    EXPECT_EQ(true, bpm.UnpinPage(last_page_id, false));
+    page_zero = bpm.FetchPage(0);
+    ASSERT_NE(nullptr, page_zero);
+    EXPECT_EQ(0, strcmp(page_zero->GetData(), "Hello"));
+  }
+  delete disk_manager;
+  remove("test.db");
+}
+
+TEST(BufferPoolManagerTest, ShardedTest) {
+  DiskManager *disk_manager = new DiskManager("test.db");
+  {
+    BufferPoolManager bpm(16, disk_manager, nullptr, 4);
+    EXPECT_EQ(4, bpm.GetNumInstances());
+
+    // every shard gets 4 frames; page ids are spread round robin
+    page_id_t temp_page_id;
+    std::vector<page_id_t> page_ids;
+    for (int i = 0; i < 16; ++i) {
+      auto page = bpm.NewPage(temp_page_id);
+      ASSERT_NE(nullptr, page);
+      snprintf(page->GetData(), PAGE_SIZE, "page %d", temp_page_id);
+      page_ids.push_back(temp_page_id);
+    }
+    // all shards are full
+    EXPECT_EQ(nullptr, bpm.NewPage(temp_page_id));
+    for (auto page_id : page_ids) {
+      EXPECT_EQ(true, bpm.UnpinPage(page_id, true));
+    }
+    // twice as many pages as frames, the first 16 are written back
+    for (int i = 0; i < 16; ++i) {
+      auto page = bpm.NewPage(temp_page_id);
+      ASSERT_NE(nullptr, page);
+      snprintf(page->GetData(), PAGE_SIZE, "page %d", temp_page_id);
+      page_ids.push_back(temp_page_id);
+      EXPECT_EQ(true, bpm.UnpinPage(temp_page_id, true));
+    }
+
+    // concurrent readers hitting every shard, forcing evictions
+    std::vector<std::thread> threads;
+    for (int tid = 0; tid < 4; ++tid) {
+      threads.push_back(std::thread([&bpm, &page_ids]() {
+        char expected[PAGE_SIZE];
+        for (int round = 0; round < 50; ++round) {
+          for (auto page_id : page_ids) {
+            auto page = bpm.FetchPage(page_id);
+            if (page == nullptr) {
+              continue;
+            }
+            snprintf(expected, PAGE_SIZE, "page %d", page_id);
+            EXPECT_EQ(0, strcmp(page->GetData(), expected));
+            bpm.UnpinPage(page_id, false);
+          }
+        }
+      }));
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+  }
+  delete disk_manager;
+  remove("test.db");
+}
+
+TEST(BufferPoolManagerTest, ConcurrentIOTest) {
+  // far more pages than frames: every fetch writes back a dirty victim and
+  // reads a page in without the latch, no update may get lost on the way
+  DiskManager *disk_manager = new DiskManager("test.db");
+  {
+    BufferPoolManager bpm(4, disk_manager);
+    const int num_pages = 32;
+
+    page_id_t temp_page_id;
+    for (int i = 0; i < num_pages; ++i) {
+      auto page = bpm.NewPage(temp_page_id);
+      ASSERT_NE(nullptr, page);
+      EXPECT_EQ(true, bpm.UnpinPage(temp_page_id, true));
+    }
+
+    std::atomic<int> updates[num_pages];
+    for (auto &update : updates) {
+      update = 0;
+    }
+    std::vector<std::thread> threads;
+    for (int tid = 0; tid < 4; ++tid) {
+      threads.push_back(std::thread([&bpm, &updates, tid]() {
+        for (int i = 0; i < 500; ++i) {
+          page_id_t page_id = (i * 7 + tid * 13) % num_pages;
+          auto page = bpm.FetchPage(page_id);
+          if (page == nullptr) {
+            continue;
+          }
+          page->WLatch();
+          ++*reinterpret_cast<int *>(page->GetData());
+          page->WUnlatch();
+          ++updates[page_id];
+          bpm.UnpinPage(page_id, true);
+        }
+      }));
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+
+    for (int page_id = 0; page_id < num_pages; ++page_id) {
+      auto page = bpm.FetchPage(page_id);
+      ASSERT_NE(nullptr, page);
+      EXPECT_EQ(updates[page_id], *reinterpret_cast<int *>(page->GetData()));
+      bpm.UnpinPage(page_id, false);
+    }
+  }
+  delete disk_manager;
+  remove("test.db");
+}
+
+TEST(BufferPoolManagerTest, PageCleanerTest) {
+  DiskManager *disk_manager = new DiskManager("test.db");
+  {
+    BufferPoolManager bpm(8, disk_manager, nullptr, 2);
+    bpm.SetCleanerTarget(8);
+    bpm.SetCleanerBatchSize(2);
+    bpm.SetCleanerInterval(std::chrono::milliseconds(10));
+
+    page_id_t temp_page_id;
+    for (int i = 0; i < 8; ++i) {
+      auto page = bpm.NewPage(temp_page_id);
+      ASSERT_NE(nullptr, page);
+      snprintf(page->GetData(), PAGE_SIZE, "page %d", temp_page_id);
+    }
+    // pinned pages are left alone
+    EXPECT_EQ(true, bpm.UnpinPage(0, true));
+    EXPECT_EQ(true, bpm.UnpinPage(1, true));
+    EXPECT_EQ(true, bpm.UnpinPage(2, true));
+    bpm.RunPageCleaner();
+
+    // the cleaner writes unpinned dirty pages without anyone asking for it
+    char data[PAGE_SIZE];
+    char expected[PAGE_SIZE];
+    for (int page_id = 0; page_id < 3; ++page_id) {
+      snprintf(expected, PAGE_SIZE, "page %d", page_id);
+      for (int retry = 0; retry < 200; ++retry) {
+        disk_manager->ReadPage(page_id, data);
+        if (strcmp(data, expected) == 0) {
+          break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      }
+      EXPECT_EQ(0, strcmp(data, expected));
+    }
+    bpm.StopPageCleaner();
+    disk_manager->ReadPage(3, data);
+    EXPECT_NE(0, strcmp(data, "page 3"));
+
+    // cleaner running while pages are evicted and fetched
+    for (int page_id = 3; page_id < 8; ++page_id) {
+      EXPECT_EQ(true, bpm.UnpinPage(page_id, true));
+    }
+    bpm.RunPageCleaner();
+    for (int round = 0; round < 20; ++round) {
+      auto page = bpm.NewPage(temp_page_id);
+      ASSERT_NE(nullptr, page);
+      snprintf(page->GetData(), PAGE_SIZE, "page %d", temp_page_id);
+      EXPECT_EQ(true, bpm.UnpinPage(temp_page_id, true));
+      for (page_id_t page_id = 0; page_id <= temp_page_id; page_id += 5) {
+        page = bpm.FetchPage(page_id);
+        ASSERT_NE(nullptr, page);
+        snprintf(expected, PAGE_SIZE, "page %d", page_id);
+        EXPECT_EQ(0, strcmp(page->GetData(), expected));
+        EXPECT_EQ(true, bpm.UnpinPage(page_id, false));
+      }
+    }
+
+  }
+  delete disk_manager;
+  remove("test.db");
+}
+
+TEST(BufferPoolManagerTest, PrefetchTest) {
+  DiskManager *disk_manager = new DiskManager("test.db");
+  {
+    BufferPoolManager bpm(8, disk_manager);
+
+    // pages 0 - 7 are written back and evicted by pages 8 - 15
+    page_id_t temp_page_id;
+    for (int i = 0; i < 16; ++i) {
+      auto page = bpm.NewPage(temp_page_id);
+      ASSERT_NE(nullptr, page);
+      snprintf(page->GetData(), PAGE_SIZE, "page %d", temp_page_id);
+      EXPECT_EQ(true, bpm.UnpinPage(temp_page_id, true));
+    }
+    EXPECT_EQ(false, bpm.FlushPage(0));
+
+    // FlushPage only succeeds on resident pages
+    bpm.Prefetch(0, 2);
+    bpm.Prefetch(100);
+    for (page_id_t page_id = 0; page_id < 2; ++page_id) {
+      for (int retry = 0; retry < 200 && !bpm.FlushPage(page_id); ++retry) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      }
+      EXPECT_EQ(true, bpm.FlushPage(page_id));
+    }
+    EXPECT_EQ(false, bpm.FlushPage(2));
+    EXPECT_EQ(false, bpm.FlushPage(100));
+
+    char expected[PAGE_SIZE];
+    for (page_id_t page_id = 0; page_id < 16; ++page_id) {
+      auto page = bpm.FetchPage(page_id);
+      ASSERT_NE(nullptr, page);
+      snprintf(expected, PAGE_SIZE, "page %d", page_id);
+      EXPECT_EQ(0, strcmp(page->GetData(), expected));
+      EXPECT_EQ(true, bpm.UnpinPage(page_id, false));
+      bpm.Prefetch(page_id + 1, 2);
+    }
+
+  }
+  delete disk_manager;
+  remove("test.db");
+}
+
+TEST(BufferPoolManagerTest, FlushAllPagesTest) {
+  DiskManager *disk_manager = new DiskManager("test.db");
+  {
+    BufferPoolManager bpm(8, disk_manager, nullptr, 2);
+
+    // page 3 stays clean, the others form the runs 0-2 and 4-7
+    page_id_t temp_page_id;
+    for (int i = 0; i < 8; ++i) {
+      auto page = bpm.NewPage(temp_page_id);
+      ASSERT_NE(nullptr, page);
+      snprintf(page->GetData(), PAGE_SIZE, "page %d", temp_page_id);
+      EXPECT_EQ(true, bpm.UnpinPage(temp_page_id, temp_page_id != 3));
+    }
+    EXPECT_EQ(7, bpm.FlushAllPages());
+    EXPECT_EQ(0, bpm.FlushAllPages());
+
+    char data[PAGE_SIZE], expected[PAGE_SIZE];
+    for (page_id_t page_id = 0; page_id < 8; ++page_id) {
+      disk_manager->ReadPage(page_id, data);
+      if (page_id == 3) {
+        EXPECT_EQ(0, data[0]);
+        continue;
+      }
+      snprintf(expected, PAGE_SIZE, "page %d", page_id);
+      EXPECT_EQ(0, strcmp(data, expected));
+    }
+
+    auto page = bpm.FetchPage(5);
+    ASSERT_NE(nullptr, page);
+    strcpy(page->GetData(), "updated");
+    EXPECT_EQ(true, bpm.UnpinPage(5, true));
+    EXPECT_EQ(1, bpm.FlushAllPages());
+    disk_manager->ReadPage(5, data);
+    EXPECT_EQ(0, strcmp(data, "updated"));
+
+    // a page a writer holds latched is left alone, it may be half changed
+    page = bpm.FetchPage(6);
+    ASSERT_NE(nullptr, page);
+    strcpy(page->GetData(), "first");
+    EXPECT_EQ(true, bpm.UnpinPage(6, true));
+    page = bpm.FetchPage(6);
+    ASSERT_NE(nullptr, page);
+    page->WLatch();
+    strcpy(page->GetData(), "half");
+    EXPECT_EQ(0, bpm.FlushAllPages());
+    disk_manager->ReadPage(6, data);
+    EXPECT_EQ(0, strcmp(data, "page 6"));
+    strcpy(page->GetData(), "second");
+    page->WUnlatch();
+    EXPECT_EQ(1, bpm.FlushAllPages());
+    EXPECT_EQ(true, bpm.UnpinPage(6, true));
+    disk_manager->ReadPage(6, data);
+    EXPECT_EQ(0, strcmp(data, "second"));
+  }
+  delete disk_manager;
+  remove("test.db");
+}
+
+TEST(BufferPoolManagerTest, WALVictimTest) {
+  DiskManager *disk_manager = new DiskManager("test.db");
+  LogManager log_manager(disk_manager);
+  log_manager.SetPersistentLSN(5);
+  ENABLE_LOGGING = true;
+  {
+    BufferPoolManager bpm(3, disk_manager, &log_manager);
+
+    // page 0 waits for the log, page 1 does not, page 2 is clean
+    page_id_t temp_page_id;
+    lsn_t lsns[] = {10, 3, 0};
+    for (int i = 0; i < 3; ++i) {
+      auto page = bpm.NewPage(temp_page_id);
+      ASSERT_NE(nullptr, page);
+      page->SetLSN(lsns[i]);
+      EXPECT_EQ(true, bpm.UnpinPage(temp_page_id, i != 2));
+    }
+
+    // LRU would pick page 0
+    ASSERT_NE(nullptr, bpm.NewPage(temp_page_id));
+    EXPECT_EQ(true, bpm.FlushPage(0));
+    EXPECT_EQ(false, bpm.FlushPage(1));
+    EXPECT_EQ(true, bpm.UnpinPage(temp_page_id, false));
+    ASSERT_NE(nullptr, bpm.NewPage(temp_page_id));
+    EXPECT_EQ(false, bpm.FlushPage(2));
+    EXPECT_EQ(true, bpm.UnpinPage(temp_page_id, false));
+    EXPECT_EQ(0, bpm.GetStats().wal_waits);
+
+    // only dirty pages ahead of the log are left, the writeback of page 0
+    // blocks until the log catches up
+    for (page_id_t page_id : {3, 4}) {
+      auto page = bpm.FetchPage(page_id);
+      ASSERT_NE(nullptr, page);
+      page->SetLSN(20);
+      EXPECT_EQ(true, bpm.UnpinPage(page_id, true));
+    }
+    std::atomic<bool> done(false);
+    std::thread evictor([&bpm, &done] {
+      page_id_t page_id;
+      EXPECT_NE(nullptr, bpm.NewPage(page_id));
+      done = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_EQ(false, done.load());
+    log_manager.SetPersistentLSN(10);
+    evictor.join();
+    EXPECT_EQ(false, bpm.FlushPage(0));
+    EXPECT_EQ(1, bpm.GetStats().wal_waits);
+  }
+  ENABLE_LOGGING = false;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BufferPoolManagerTest, StatsTest) {
+  DiskManager *disk_manager = new DiskManager("test.db");
+  {
+    BufferPoolManager bpm(4, disk_manager);
+
+    // pages 0 and 1 are dirty victims of pages 4 and 5
+    page_id_t temp_page_id;
+    for (int i = 0; i < 6; ++i) {
+      ASSERT_NE(nullptr, bpm.NewPage(temp_page_id));
+      EXPECT_EQ(true, bpm.UnpinPage(temp_page_id, true));
+    }
+    // two hits on the same page, then a miss that evicts page 2
+    EXPECT_NE(nullptr, bpm.FetchPage(5));
+    EXPECT_NE(nullptr, bpm.FetchPage(5));
+    EXPECT_NE(nullptr, bpm.FetchPage(0));
+
+    BufferPoolStats stats = bpm.GetStats();
+    EXPECT_EQ(6, stats.new_pages);
+    EXPECT_EQ(2, stats.fetch_hits);
+    EXPECT_EQ(1, stats.fetch_misses);
+    EXPECT_EQ(3, stats.evictions);
+    EXPECT_EQ(3, stats.writebacks);
+    EXPECT_EQ(0, stats.cleaner_writebacks);
+    EXPECT_EQ(0, stats.prefetches);
+    EXPECT_EQ(0, stats.latch_waits);
+    EXPECT_EQ(0, stats.latch_wait_ns);
+    EXPECT_EQ(2, stats.pin_count_histogram[0]);
+    EXPECT_EQ(1, stats.pin_count_histogram[1]);
+    EXPECT_DOUBLE_EQ(2.0 / 3, stats.GetHitRatio());
+
+    EXPECT_EQ(true, bpm.UnpinPage(5, false));
+    EXPECT_EQ(true, bpm.UnpinPage(5, false));
+    EXPECT_EQ(true, bpm.UnpinPage(0, false));
+  }
+  delete disk_manager;
+  remove("test.db");
+}
+
+TEST(BufferPoolManagerTest, CompressedCacheTest) {
+  DiskManager *disk_manager = new DiskManager("test.db");
+  {
+    BufferPoolManager bpm(2, disk_manager, nullptr, 1, ReplacerPolicy::LRU,
+                          64 * PAGE_SIZE);
+
+    page_id_t page_ids[8];
+    for (int i = 0; i < 8; ++i) {
+      Page *page = bpm.NewPage(page_ids[i]);
+      ASSERT_NE(nullptr, page);
+      snprintf(page->GetData(), PAGE_SIZE, "Hello %d", i);
+      EXPECT_EQ(true, bpm.UnpinPage(page_ids[i], true));
+    }
+    // page 0 was written back and compressed when it was evicted, the misses
+    // below are served from the cache and never see what is on disk now
+    char garbage[PAGE_SIZE];
+    memset(garbage, 'x', PAGE_SIZE);
+    disk_manager->WritePage(page_ids[0], garbage);
+
+    char expected[PAGE_SIZE];
+    for (int round = 0; round < 2; ++round) {
+      for (int i = 0; i < 6; ++i) {
+        Page *page = bpm.FetchPage(page_ids[i]);
+        ASSERT_NE(nullptr, page);
+        snprintf(expected, PAGE_SIZE, "Hello %d", i);
+        EXPECT_EQ(0, strcmp(expected, page->GetData()));
+        EXPECT_EQ(true, bpm.UnpinPage(page_ids[i], false));
+      }
+    }
+
+    BufferPoolStats stats = bpm.GetStats();
+    EXPECT_EQ(12, stats.tier2_hits);
+    EXPECT_EQ(0, stats.tier2_misses);
+    EXPECT_DOUBLE_EQ(1.0, stats.GetTier2HitRatio());
+    EXPECT_LT(20.0, stats.GetCompressionRatio());
+  }
+  delete disk_manager;
+  remove("test.db");
+}
+
+TEST(BufferPoolManagerTest, ResizeTest) {
+  DiskManager *disk_manager = new DiskManager("test.db");
+  {
+    BufferPoolManager bpm(4, disk_manager);
+
+    // grow while every frame is pinned
+    std::vector<page_id_t> page_ids(8);
+    for (int i = 0; i < 4; ++i) {
+      Page *page = bpm.NewPage(page_ids[i]);
+      ASSERT_NE(nullptr, page);
+      snprintf(page->GetData(), PAGE_SIZE, "Hello %d", i);
+    }
+    page_id_t temp_page_id;
+    EXPECT_EQ(nullptr, bpm.NewPage(temp_page_id));
+    EXPECT_EQ(8, bpm.Resize(8));
+    EXPECT_EQ(8, bpm.GetPoolSize());
+    for (int i = 4; i < 8; ++i) {
+      Page *page = bpm.NewPage(page_ids[i]);
+      ASSERT_NE(nullptr, page);
+      snprintf(page->GetData(), PAGE_SIZE, "Hello %d", i);
+    }
+
+    // pinned frames are not taken away
+    EXPECT_EQ(8, bpm.Resize(2));
+    for (int i = 0; i < 8; ++i) {
+      EXPECT_EQ(true, bpm.UnpinPage(page_ids[i], true));
+    }
+    // now they are, their pages were written back
+    EXPECT_EQ(2, bpm.Resize(2));
+    char expected[PAGE_SIZE];
+    for (int i = 0; i < 8; ++i) {
+      Page *page = bpm.FetchPage(page_ids[i]);
+      ASSERT_NE(nullptr, page);
+      snprintf(expected, PAGE_SIZE, "Hello %d", i);
+      EXPECT_EQ(0, strcmp(expected, page->GetData()));
+      EXPECT_EQ(true, bpm.UnpinPage(page_ids[i], false));
+    }
+
+    // retired frames come back first, then the arena grows up to its limit
+    EXPECT_EQ(4 * BUFFER_POOL_MAX_GROWTH, bpm.Resize(1000));
+  }
+  delete disk_manager;
+  remove("test.db");
+}
+
+TEST(BufferPoolManagerTest, ConcurrentResizeTest) {
+  const int num_pages = 64;
+  for (auto policy : {ReplacerPolicy::LRU, ReplacerPolicy::CLOCK,
+                      ReplacerPolicy::LRU_K, ReplacerPolicy::ARC}) {
+    DiskManager *disk_manager = new DiskManager("test.db");
+    {
+      BufferPoolManager bpm(16, disk_manager, nullptr, 2, policy);
+      std::vector<page_id_t> page_ids(num_pages);
+      for (int i = 0; i < num_pages; ++i) {
+        Page *page = bpm.NewPage(page_ids[i]);
+        ASSERT_NE(nullptr, page);
+        snprintf(page->GetData(), PAGE_SIZE, "Hello %d", page_ids[i]);
+        EXPECT_EQ(true, bpm.UnpinPage(page_ids[i], true));
+      }
+
+      // readers keep going while the pool shrinks and grows underneath
+      std::atomic<bool> done(false);
+      std::vector<std::thread> threads;
+      for (int tid = 0; tid < 4; ++tid) {
+        threads.push_back(std::thread([&, tid]() {
+          char expected[PAGE_SIZE];
+          for (int i = 0; !done; ++i) {
+            page_id_t page_id = page_ids[(i * 7 + tid) % num_pages];
+            Page *page = bpm.FetchPage(page_id);
+            if (page == nullptr) {
+              continue;
+            }
+            snprintf(expected, PAGE_SIZE, "Hello %d", page_id);
+            EXPECT_EQ(0, strcmp(expected, page->GetData()));
+            EXPECT_EQ(true, bpm.UnpinPage(page_id, i % 3 == 0));
+          }
+        }));
+      }
+      for (int round = 0; round < 50; ++round) {
+        size_t size = bpm.Resize(round % 2 == 0 ? 6 : 48);
+        EXPECT_LE(6, size);
+        EXPECT_GE(48, size);
+      }
+      done = true;
+      for (auto &thread : threads) {
+        thread.join();
+      }
+      EXPECT_EQ(48, bpm.Resize(48));
+    }
+    delete disk_manager;
+    remove("test.db");
+  }
+}
+
+TEST(BufferPoolManagerTest, AccessStrategyTest) {
+  DiskManager *disk_manager = new DiskManager("test.db");
+  {
+    BufferPoolManager bpm(32, disk_manager);
+
+    // a table of 64 pages, then a working set of 8 pages
+    std::vector<page_id_t> page_ids(72);
+    for (int i = 0; i < 72; ++i) {
+      Page *page = bpm.NewPage(page_ids[i]);
+      ASSERT_NE(nullptr, page);
+      snprintf(page->GetData(), PAGE_SIZE, "Hello %d", i);
+      EXPECT_EQ(true, bpm.UnpinPage(page_ids[i], true));
+    }
+
+    // scan the table through a ring of 4 frames
+    char expected[PAGE_SIZE];
+    {
+      auto strategy = bpm.GetAccessStrategy(4);
+      EXPECT_EQ(4, strategy->GetRingSize());
+      for (int i = 0; i < 64; ++i) {
+        Page *page = bpm.FetchPage(page_ids[i], strategy.get());
+        ASSERT_NE(nullptr, page);
+        snprintf(expected, PAGE_SIZE, "Hello %d", i);
+        EXPECT_EQ(0, strcmp(expected, page->GetData()));
+        EXPECT_EQ(true, bpm.UnpinPage(page_ids[i], false));
+      }
+    }
+    // the ring took 4 victims, pages 40 to 43 among them, and recycled its
+    // frames for the other misses. pages 44 to 63 were hits
+    BufferPoolStats stats = bpm.GetStats();
+    EXPECT_EQ(44, stats.evictions);
+    EXPECT_EQ(40, stats.ring_reuses);
+    EXPECT_EQ(20, stats.fetch_hits);
+
+    // the working set is still there
+    for (int i = 64; i < 72; ++i) {
+      EXPECT_NE(nullptr, bpm.FetchPage(page_ids[i]));
+      EXPECT_EQ(true, bpm.UnpinPage(page_ids[i], false));
+    }
+    EXPECT_EQ(28, bpm.GetStats().fetch_hits);
+
+    // the ring frames went back to the replacer when the strategy went away,
+    // so all but 4 frames can be retired
+    EXPECT_EQ(4, bpm.Resize(4));
+
+    // a ring of one frame never recycles, and a ring with room for a full
+    // read-ahead window would take too much of a small pool
+    EXPECT_EQ(nullptr, bpm.GetAccessStrategy(1));
+    EXPECT_EQ(nullptr, bpm.GetAccessStrategy());
+    EXPECT_EQ(64, bpm.Resize(64));
+    auto strategy = bpm.GetAccessStrategy();
+    ASSERT_NE(nullptr, strategy);
+    EXPECT_EQ(READ_AHEAD_PAGES + 1, strategy->GetRingSize());
+  }
+  delete disk_manager;
+  remove("test.db");
+}
+
+TEST(BufferPoolManagerTest, WarmUpTest) {
+  DiskManager *disk_manager = new DiskManager("test.db");
+  {
+    BufferPoolManager bpm(8, disk_manager);
+
+    // 32 pages, then touch pages 20 - 27 so that they are the resident ones
+    page_id_t temp_page_id;
+    for (int i = 0; i < 32; ++i) {
+      auto page = bpm.NewPage(temp_page_id);
+      ASSERT_NE(nullptr, page);
+      snprintf(page->GetData(), PAGE_SIZE, "page %d", temp_page_id);
+      EXPECT_EQ(true, bpm.UnpinPage(temp_page_id, true));
+    }
+    for (page_id_t page_id = 20; page_id < 28; ++page_id) {
+      EXPECT_NE(nullptr, bpm.FetchPage(page_id));
+      EXPECT_EQ(true, bpm.UnpinPage(page_id, false));
+    }
+    bpm.FlushAllPages();
+    EXPECT_EQ(8, bpm.DumpPages("test.warmup"));
+  }
+  {
+    // after a restart the same pages are read back
+    BufferPoolManager bpm(8, disk_manager);
+    EXPECT_EQ(8, bpm.LoadPages("test.warmup"));
+    for (page_id_t page_id = 20; page_id < 28; ++page_id) {
+      for (int retry = 0; retry < 200 && !bpm.FlushPage(page_id); ++retry) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      }
+    }
+    char expected[PAGE_SIZE];
+    for (page_id_t page_id = 20; page_id < 28; ++page_id) {
+      auto page = bpm.FetchPage(page_id);
+      ASSERT_NE(nullptr, page);
+      snprintf(expected, PAGE_SIZE, "page %d", page_id);
+      EXPECT_EQ(0, strcmp(page->GetData(), expected));
+      EXPECT_EQ(true, bpm.UnpinPage(page_id, false));
+    }
+    BufferPoolStats stats = bpm.GetStats();
+    EXPECT_EQ(8, stats.fetch_hits);
+    EXPECT_EQ(0, stats.fetch_misses);
+  }
+  {
+    // a smaller pool only takes the most recently used pages
+    BufferPoolManager bpm(4, disk_manager);
+    EXPECT_EQ(4, bpm.LoadPages("test.warmup"));
+    for (page_id_t page_id = 24; page_id < 28; ++page_id) {
+      for (int retry = 0; retry < 200 && !bpm.FlushPage(page_id); ++retry) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      }
+      EXPECT_EQ(true, bpm.FlushPage(page_id));
+    }
+    EXPECT_EQ(false, bpm.FlushPage(20));
+
+    // a missing or corrupted file is ignored
+    EXPECT_EQ(0, bpm.LoadPages("missing.warmup"));
+    FILE *file = fopen("test.warmup", "r+b");
+    ASSERT_NE(nullptr, file);
+    fputc('X', file);
+    fclose(file);
+    EXPECT_EQ(0, bpm.LoadPages("test.warmup"));
+  }
+  delete disk_manager;
+  remove("test.db");
+  remove("test.warmup");
+}
+
+TEST(BufferPoolManagerTest, DeletePageTest) {
+  DiskManager *disk_manager = new DiskManager("test.db");
+  {
+    BufferPoolManager bpm(4, disk_manager);
+    page_id_t temp_page_id;
+    for (int i = 0; i < 8; ++i) {
+      ASSERT_NE(nullptr, bpm.NewPage(temp_page_id));
+      EXPECT_EQ(true, bpm.UnpinPage(temp_page_id, true));
+    }
+    bpm.FlushAllPages();
+
+    // a pinned page stays, an unpinned or evicted one is deallocated
+    EXPECT_NE(nullptr, bpm.FetchPage(7));
+    EXPECT_EQ(false, bpm.DeletePage(7));
+    EXPECT_EQ(true, bpm.UnpinPage(7, false));
+    EXPECT_EQ(true, bpm.DeletePage(7));
+    EXPECT_EQ(false, bpm.FlushPage(7));
+    EXPECT_EQ(true, bpm.DeletePage(1));
+
+    // the next new pages take the freed ids
+    auto page = bpm.NewPage(temp_page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(1, temp_page_id);
+    EXPECT_EQ(0, page->GetData()[0]);
+    EXPECT_EQ(true, bpm.UnpinPage(temp_page_id, false));
+    EXPECT_NE(nullptr, bpm.NewPage(temp_page_id));
+    EXPECT_EQ(7, temp_page_id);
+    EXPECT_EQ(true, bpm.UnpinPage(temp_page_id, false));
+    EXPECT_EQ(8, disk_manager->GetNextPageId());
+  }
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BufferPoolManagerTest, RecycledPageTest) {
+  DiskManager *disk_manager = new DiskManager("test.db");
+  {
+    BufferPoolManager bpm(16, disk_manager);
+    page_id_t temp_page_id;
+    for (int i = 0; i < 6; ++i) {
+      ASSERT_NE(nullptr, bpm.NewPage(temp_page_id));
+      EXPECT_EQ(true, bpm.UnpinPage(temp_page_id, true));
+    }
+    EXPECT_EQ(true, bpm.DeletePage(2));
+
+    // read-ahead skips the deleted page, a stale reader still brings it in
+    bpm.Prefetch(2, 1);
+    auto page = bpm.FetchPage(2);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(true, bpm.UnpinPage(2, false));
+
+    // the recycled id replaces the stale copy instead of sitting next to it
+    ASSERT_NE(nullptr, page = bpm.NewPage(temp_page_id));
+    EXPECT_EQ(2, temp_page_id);
+    strcpy(page->GetData(), "NEWDATA");
+    EXPECT_EQ(true, bpm.UnpinPage(2, true));
+    for (int i = 0; i < 15; ++i) {
+      ASSERT_NE(nullptr, bpm.NewPage(temp_page_id));
+      EXPECT_EQ(true, bpm.UnpinPage(temp_page_id, false));
+    }
+    // evicting the stale copy must not have unmapped the new page
+    EXPECT_EQ(true, bpm.FlushPage(2));
+    char data[PAGE_SIZE];
+    disk_manager->ReadPage(2, data);
+    EXPECT_EQ(0, strcmp(data, "NEWDATA"));
+    ASSERT_NE(nullptr, page = bpm.FetchPage(2));
+    EXPECT_EQ(0, strcmp(page->GetData(), "NEWDATA"));
+    EXPECT_EQ(true, bpm.UnpinPage(2, false));
+
+    // a recycled id still pinned by a stale reader can not be handed out
+    EXPECT_EQ(true, bpm.DeletePage(2));
+    ASSERT_NE(nullptr, bpm.FetchPage(2));
+    EXPECT_EQ(nullptr, bpm.NewPage(temp_page_id));
+    EXPECT_EQ(true, bpm.UnpinPage(2, false));
+  }
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BufferPoolManagerTest, MappedReadTest) {
+  DiskManager *disk_manager = new DiskManager("test.db");
+  page_id_t temp_page_id;
+  {
+    BufferPoolManager writer(16, disk_manager);
+    for (int i = 0; i < 32; ++i) {
+      auto page = writer.NewPage(temp_page_id);
+      ASSERT_NE(nullptr, page);
+      snprintf(page->GetData(), PAGE_SIZE, "page %d", temp_page_id);
+      EXPECT_EQ(true, writer.UnpinPage(temp_page_id, true));
+    }
+    writer.FlushAllPages();
+
+    // the file is not mapped while a writer is around, pages are copied
+    BufferPoolManager reader(8, disk_manager, nullptr, 2, ReplacerPolicy::LRU,
+                             0, true);
+    EXPECT_EQ(true, reader.IsReadOnly());
+    EXPECT_EQ(false, reader.IsMapped());
+    auto page = reader.FetchPage(3);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(0, strcmp(page->GetData(), "page 3"));
+    EXPECT_EQ(true, reader.UnpinPage(3, false));
+    EXPECT_EQ(0, reader.GetStats().mapped_reads);
+  }
+
+  {
+    BufferPoolManager reader(8, disk_manager, nullptr, 2, ReplacerPolicy::LRU,
+                             0, true);
+    EXPECT_EQ(nullptr, reader.NewPage(temp_page_id));
+    EXPECT_EQ(INVALID_PAGE_ID, temp_page_id);
+    EXPECT_EQ(false, reader.DeletePage(0));
+    ASSERT_EQ(true, reader.IsMapped());
+
+    // the frames point into the mapping, no copy is made
+    char expected[PAGE_SIZE];
+    auto strategy = reader.GetAccessStrategy(4);
+    reader.Prefetch(0, 32);
+    for (page_id_t page_id = 0; page_id < 32; ++page_id) {
+      auto page = reader.FetchPage(page_id, strategy.get());
+      ASSERT_NE(nullptr, page);
+      EXPECT_EQ(disk_manager->GetMappedPage(page_id), page->GetData());
+      snprintf(expected, PAGE_SIZE, "page %d", page_id);
+      EXPECT_EQ(0, strcmp(page->GetData(), expected));
+      EXPECT_EQ(true, reader.UnpinPage(page_id, true));
+    }
+    strategy.reset();
+    EXPECT_EQ(32, reader.GetStats().mapped_reads);
+    EXPECT_EQ(0, reader.GetStats().prefetches);
+
+    // no writer while pages are served from the mapping
+    EXPECT_THROW(BufferPoolManager writer(16, disk_manager), Exception);
+
+    // a page past the end of the file is read into the frame, as zeros
+    Page *page;
+    ASSERT_NE(nullptr, page = reader.FetchPage(100));
+    EXPECT_EQ(nullptr, disk_manager->GetMappedPage(100));
+    EXPECT_EQ(0, page->GetData()[0]);
+    EXPECT_EQ(true, reader.UnpinPage(100, false));
+  }
+
+  // once the reader is gone pages can be changed and added again
+  {
+    BufferPoolManager writer(16, disk_manager);
+    auto page = writer.FetchPage(5);
+    ASSERT_NE(nullptr, page);
+    strcpy(page->GetData(), "changed");
+    EXPECT_EQ(true, writer.UnpinPage(5, true));
+    ASSERT_NE(nullptr, page = writer.NewPage(temp_page_id));
+    EXPECT_EQ(32, temp_page_id);
+    strcpy(page->GetData(), "new page");
+    EXPECT_EQ(true, writer.UnpinPage(temp_page_id, true));
+    writer.FlushAllPages();
+  }
+
+  // and the next reader sees them
+  {
+    BufferPoolManager reader(8, disk_manager, nullptr, 2, ReplacerPolicy::LRU,
+                             0, true);
+    ASSERT_EQ(true, reader.IsMapped());
+    Page *page;
+    ASSERT_NE(nullptr, page = reader.FetchPage(5));
+    EXPECT_EQ(0, strcmp(page->GetData(), "changed"));
+    EXPECT_EQ(true, reader.UnpinPage(5, false));
+    ASSERT_NE(nullptr, page = reader.FetchPage(32));
+    EXPECT_EQ(disk_manager->GetMappedPage(32), page->GetData());
+    EXPECT_EQ(0, strcmp(page->GetData(), "new page"));
+    EXPECT_EQ(true, reader.UnpinPage(32, false));
+  }
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BufferPoolManagerTest, ReadAheadBatchTest) {
+  DiskManager *disk_manager = new DiskManager("test.db");
+  {
+    BufferPoolManager bpm(8, disk_manager);
+    page_id_t temp_page_id;
+    for (int i = 0; i < 64; ++i) {
+      auto page = bpm.NewPage(temp_page_id);
+      ASSERT_NE(nullptr, page);
+      snprintf(page->GetData(), PAGE_SIZE, "page %d", temp_page_id);
+      EXPECT_EQ(true, bpm.UnpinPage(temp_page_id, true));
+    }
+
+    // 5 of the 8 frames are pinned. a read-ahead batch pins at most a
+    // quarter of the pool, so a fetch running next to it always finds a frame
+    for (page_id_t page_id = 0; page_id < 5; ++page_id) {
+      ASSERT_NE(nullptr, bpm.FetchPage(page_id));
+    }
+    std::atomic<bool> done(false);
+    std::atomic<int> failed_fetches(0);
+    std::thread fetcher([&bpm, &done, &failed_fetches]() {
+      for (int round = 0; !done; ++round) {
+        page_id_t page_id = 56 + round % 8;
+        if (bpm.FetchPage(page_id) == nullptr) {
+          ++failed_fetches;
+          continue;
+        }
+        bpm.UnpinPage(page_id, false);
+      }
+    });
+    for (int round = 0; round < 200; ++round) {
+      for (page_id_t page_id = 8; page_id < 56; page_id += 2) {
+        bpm.Prefetch(page_id, 2);
+      }
+    }
+    done = true;
+    fetcher.join();
+    EXPECT_EQ(0, failed_fetches);
+
+    for (page_id_t page_id = 0; page_id < 5; ++page_id) {
+      EXPECT_EQ(true, bpm.UnpinPage(page_id, false));
+    }
+  }
+  delete disk_manager;
+  remove("test.db");
+}
+
 } // namespace cmudb
@@ -0,0 +1,61 @@
+/**
+ * clock_replacer_test.cpp
+ */
+
+#include <cstdio>
+
+#include "buffer/clock_replacer.h"
+#include "buffer/frame_arena.h"
+#include "gtest/gtest.h"
+namespace cmudb {
+
+TEST(ClockReplacerTest, SampleTest) {
+  ClockReplacer<int> clock_replacer(7);
+
+  // push element into replacer
+  clock_replacer.Insert(1);
+  clock_replacer.Insert(2);
+  clock_replacer.Insert(3);
+  clock_replacer.Insert(4);
+  clock_replacer.Insert(5);
+  clock_replacer.Insert(6);
+  clock_replacer.Insert(1);
+  EXPECT_EQ(6, clock_replacer.Size());
+
+  // every frame is referenced, the first sweep only clears the bits
+  int value;
+  clock_replacer.Victim(value);
+  EXPECT_EQ(1, value);
+  clock_replacer.Victim(value);
+  EXPECT_EQ(2, value);
+  clock_replacer.Victim(value);
+  EXPECT_EQ(3, value);
+
+  // remove element from replacer
+  EXPECT_EQ(false, clock_replacer.Erase(3));
+  EXPECT_EQ(true, clock_replacer.Erase(6));
+  EXPECT_EQ(2, clock_replacer.Size());
+
+  // a referenced frame gets a second chance
+  clock_replacer.Insert(4);
+  clock_replacer.Victim(value);
+  EXPECT_EQ(5, value);
+  clock_replacer.Victim(value);
+  EXPECT_EQ(4, value);
+  EXPECT_EQ(false, clock_replacer.Victim(value));
+}
+
+TEST(ClockReplacerTest, PagePointerTest) {
+  FrameArena arena(4, PAGE_SIZE);
+  Page *pages = arena.GetFrames();
+  ClockReplacer<Page *> clock_replacer(4, pages);
+  clock_replacer.Insert(&pages[2]);
+  clock_replacer.Insert(&pages[3]);
+  EXPECT_EQ(true, clock_replacer.Erase(&pages[3]));
+
+  Page *victim;
+  EXPECT_EQ(true, clock_replacer.Victim(victim));
+  EXPECT_EQ(&pages[2], victim);
+  EXPECT_EQ(0, clock_replacer.Size());
+}
+} // namespace cmudb
@@ -0,0 +1,93 @@
+/**
+ * compressed_cache_test.cpp
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "buffer/compressed_cache.h"
+#include "gtest/gtest.h"
+
+namespace cmudb {
+
+TEST(CompressedCacheTest, CodecTest) {
+  const size_t page_size = 8192;
+  std::mt19937 random(15445);
+  std::vector<std::vector<char>> pages;
+  // empty, half filled with records, noise
+  pages.emplace_back(page_size, 0);
+  pages.emplace_back(page_size, 0);
+  for (size_t i = 0; i < page_size / 2; i += 32) {
+    snprintf(&pages.back()[i], 32, "record %zu, value %u", i,
+             static_cast<unsigned>(random() % 100));
+  }
+  pages.emplace_back(page_size);
+  for (auto &c : pages.back()) {
+    c = static_cast<char>(random());
+  }
+
+  std::vector<char> compressed(CompressedCache::MaxCompressedSize(page_size));
+  std::vector<char> restored(page_size);
+  std::vector<size_t> sizes;
+  for (auto &page : pages) {
+    size_t size = CompressedCache::Compress(page.data(), page_size,
+                                            compressed.data());
+    EXPECT_GE(compressed.size(), size);
+    sizes.push_back(size);
+    EXPECT_EQ(true, CompressedCache::Decompress(compressed.data(), size,
+                                                restored.data(), page_size));
+    EXPECT_EQ(0, memcmp(page.data(), restored.data(), page_size));
+    // a truncated input is rejected
+    EXPECT_EQ(false, CompressedCache::Decompress(compressed.data(), size - 1,
+                                                 restored.data(), page_size));
+  }
+  EXPECT_GT(page_size / 32, sizes[0]);
+  EXPECT_GT(page_size / 2, sizes[1]);
+  EXPECT_LT(page_size, sizes[2]);
+}
+
+TEST(CompressedCacheTest, SampleTest) {
+  const size_t page_size = 4096;
+  std::vector<char> page(page_size, 0);
+  std::vector<char> out(page_size);
+  CompressedCache cache(page_size, page_size);
+
+  // zero pages are tiny, many of them fit
+  for (int i = 0; i < 10; ++i) {
+    page[0] = static_cast<char>(i);
+    EXPECT_NE(0, cache.Insert(i, page.data()));
+  }
+  EXPECT_EQ(10, cache.Size());
+
+  // taking a page drops it
+  EXPECT_EQ(true, cache.Take(3, out.data()));
+  EXPECT_EQ(3, out[0]);
+  EXPECT_EQ(false, cache.Take(3, out.data()));
+  cache.Erase(4);
+  EXPECT_EQ(false, cache.Take(4, out.data()));
+  EXPECT_EQ(8, cache.Size());
+
+  // a newer copy replaces the old one
+  page[0] = 42;
+  cache.Insert(5, page.data());
+  EXPECT_EQ(8, cache.Size());
+  EXPECT_EQ(true, cache.Take(5, out.data()));
+  EXPECT_EQ(42, out[0]);
+
+  // an incompressible page is stored as is and pushes the oldest pages out
+  std::mt19937 random(15445);
+  for (auto &c : page) {
+    c = static_cast<char>(random());
+  }
+  EXPECT_EQ(page_size, cache.Insert(100, page.data()));
+  EXPECT_EQ(page_size, cache.GetBytes());
+  EXPECT_EQ(1, cache.Size());
+  EXPECT_EQ(false, cache.Take(0, out.data()));
+  EXPECT_EQ(true, cache.Take(100, out.data()));
+  EXPECT_EQ(0, memcmp(page.data(), out.data(), page_size));
+  EXPECT_EQ(0, cache.GetBytes());
+}
+
+} // namespace cmudb
@@ -0,0 +1,73 @@
+/**
+ * frame_arena_test.cpp
+ */
+
+#include <cstdint>
+#include <cstring>
+
+#include "buffer/frame_arena.h"
+#include "gtest/gtest.h"
+
+namespace cmudb {
+
+TEST(FrameArenaTest, LayoutTest) {
+  EXPECT_EQ(0, sizeof(Page) % CACHELINE_SIZE);
+
+  for (bool use_huge_pages : {false, true}) {
+    FrameArena arena(16, 8192, use_huge_pages);
+    Page *frames = arena.GetFrames();
+    EXPECT_EQ(16, arena.GetNumFrames());
+    for (size_t i = 0; i < arena.GetNumFrames(); ++i) {
+      // no two descriptors share a cache line
+      EXPECT_EQ(0, reinterpret_cast<uintptr_t>(&frames[i]) % CACHELINE_SIZE);
+      EXPECT_EQ(8192, frames[i].GetPageSize());
+      EXPECT_EQ(INVALID_PAGE_ID, frames[i].GetPageId());
+      // page bytes are contiguous and aligned for direct I/O
+      EXPECT_EQ(frames[0].GetData() + i * 8192, frames[i].GetData());
+      EXPECT_EQ(0, reinterpret_cast<uintptr_t>(frames[i].GetData()) % 4096);
+      EXPECT_EQ(0, frames[i].GetData()[8191]);
+    }
+  }
+}
+
+TEST(FrameArenaTest, GrowTest) {
+  FrameArena arena(2, 4096, false, 4);
+  Page *frames = arena.GetFrames();
+  EXPECT_EQ(2, arena.GetNumFrames());
+  EXPECT_EQ(4, arena.GetMaxFrames());
+
+  // frames are added in place, the existing ones do not move
+  EXPECT_EQ(&frames[2], arena.AddFrame());
+  EXPECT_EQ(&frames[3], arena.AddFrame());
+  EXPECT_EQ(nullptr, arena.AddFrame());
+  EXPECT_EQ(4, arena.GetNumFrames());
+  EXPECT_EQ(frames[0].GetData() + 3 * 4096, frames[3].GetData());
+  EXPECT_EQ(4096, frames[3].GetPageSize());
+
+  // a released frame reads as zeros
+  memset(frames[1].GetData(), 'x', 4096);
+  arena.ReleaseFrame(&frames[1]);
+  EXPECT_EQ(0, frames[1].GetData()[0]);
+  EXPECT_EQ(0, frames[1].GetData()[4095]);
+}
+
+TEST(FrameArenaTest, HugePageGrowTest) {
+  // room for far more frames than the huge page pool can back usually
+  FrameArena arena(16, 65536, true, 16 * 1024);
+  if (!arena.IsHugeTLB()) {
+    // no huge pages reserved on this machine
+    return;
+  }
+  // every frame handed out is backed, growth stops when huge pages run out
+  Page *frame;
+  while ((frame = arena.AddFrame()) != nullptr) {
+    memset(frame->GetData(), 'x', 65536);
+  }
+  EXPECT_LE(16, arena.GetNumFrames());
+  EXPECT_GT(16 * 1024, arena.GetNumFrames());
+  for (size_t i = 0; i < 16; ++i) {
+    memset(arena.GetFrames()[i].GetData(), 'y', 65536);
+  }
+}
+
+} // namespace cmudb
@@ -0,0 +1,109 @@
+/**
+ * lru_k_replacer_test.cpp
+ */
+
+#include <cstdio>
+#include <random>
+#include <unordered_set>
+
+#include "buffer/lru_k_replacer.h"
+#include "buffer/lru_replacer.h"
+#include "gtest/gtest.h"
+
+namespace cmudb {
+
+TEST(LRUKReplacerTest, SampleTest) {
+  LRUKReplacer<int> lru_k_replacer(2);
+
+  // 1 and 2 are accessed twice, the rest once
+  lru_k_replacer.Insert(1);
+  lru_k_replacer.Insert(2);
+  lru_k_replacer.Insert(3);
+  lru_k_replacer.Insert(4);
+  lru_k_replacer.Insert(1);
+  lru_k_replacer.Insert(5);
+  lru_k_replacer.Insert(2);
+  EXPECT_EQ(5, lru_k_replacer.Size());
+
+  // pages with less than k accesses go first, oldest access first
+  int value;
+  lru_k_replacer.Victim(value);
+  EXPECT_EQ(3, value);
+  lru_k_replacer.Victim(value);
+  EXPECT_EQ(4, value);
+
+  // pinned page keeps its history but can not be evicted
+  EXPECT_EQ(true, lru_k_replacer.Erase(5));
+  EXPECT_EQ(false, lru_k_replacer.Erase(5));
+  EXPECT_EQ(false, lru_k_replacer.Erase(3));
+  EXPECT_EQ(2, lru_k_replacer.Size());
+
+  // then by the second most recent access
+  lru_k_replacer.Victim(value);
+  EXPECT_EQ(1, value);
+
+  // unpinned again, 5 now has two accesses and 2 has the older one
+  lru_k_replacer.Insert(5);
+  lru_k_replacer.Victim(value);
+  EXPECT_EQ(2, value);
+  lru_k_replacer.Victim(value);
+  EXPECT_EQ(5, value);
+  EXPECT_EQ(false, lru_k_replacer.Victim(value));
+}
+
+namespace {
+/*
+ * Replay an access trace against a cache of num_frames frames managed by
+ * replacer, every access is a pin immediately followed by an unpin. Return
+ * the hit ratio.
+ */
+double Replay(Replacer<int> &replacer, size_t num_frames,
+              const std::vector<int> &trace) {
+  std::unordered_set<int> resident;
+  size_t hits = 0;
+  for (int page_id : trace) {
+    if (resident.count(page_id) > 0) {
+      ++hits;
+      replacer.Erase(page_id);
+    } else {
+      if (resident.size() == num_frames) {
+        int victim;
+        EXPECT_EQ(true, replacer.Victim(victim));
+        resident.erase(victim);
+      }
+      resident.insert(page_id);
+    }
+    replacer.Insert(page_id);
+  }
+  return static_cast<double>(hits) / trace.size();
+}
+} // namespace
+
+TEST(LRUKReplacerTest, ScanResistanceBenchmark) {
+  // index lookups hit a working set of internal pages that fits in the pool,
+  // while a full table scan streams through pages that are never reused
+  const size_t num_frames = 64;
+  const int index_pages = 48;
+  const int scan_pages = 100000;
+  std::mt19937 rng(15721);
+  std::uniform_int_distribution<int> index_page(0, index_pages - 1);
+
+  std::vector<int> trace;
+  for (int i = 0; i < scan_pages; ++i) {
+    trace.push_back(index_page(rng));
+    trace.push_back(index_pages + i);
+  }
+
+  LRUReplacer<int> lru_replacer;
+  LRUKReplacer<int> lru_k_replacer(2);
+  double lru = Replay(lru_replacer, num_frames, trace);
+  double lru_k = Replay(lru_k_replacer, num_frames, trace);
+  printf("hit ratio on index lookups mixed with a scan: LRU %.3f, LRU-2 %.3f\n",
+         lru, lru_k);
+
+  // every scan access is a miss, so 0.5 is the best possible
+  EXPECT_GT(lru_k, lru);
+  EXPECT_GT(lru_k, 0.45);
+}
+
+} // namespace cmudb
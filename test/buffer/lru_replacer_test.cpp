@@ -4,9 +4,9 @@
 
 #include <cstdio>
 
+#include "buffer/frame_arena.h"
 #include "buffer/lru_replacer.h"
 #include "gtest/gtest.h"
-#include <page/page.h>
 namespace cmudb {
 
 TEST(LRUReplacerTest, SampleTest) {
@@ -42,10 +42,32 @@ TEST(LRUReplacerTest, SampleTest) {
   lru_replacer.Victim(value);
   EXPECT_EQ(1, value);
 }
+TEST(LRUReplacerTest, FilterTest) {
+  LRUReplacer<int> lru_replacer;
+  for (int i = 1; i <= 4; ++i) {
+    lru_replacer.Insert(i);
+  }
+
+  // the least recently used value accepted by the filter
+  int value;
+  auto even = [](const int &v) { return v % 2 == 0; };
+  EXPECT_EQ(true, lru_replacer.Victim(value, even));
+  EXPECT_EQ(2, value);
+  EXPECT_EQ(true, lru_replacer.Victim(value, even));
+  EXPECT_EQ(4, value);
+  EXPECT_EQ(false, lru_replacer.Victim(value, even));
+  EXPECT_EQ(2, lru_replacer.Size());
+
+  // rejected values keep their place
+  EXPECT_EQ(true, lru_replacer.Victim(value));
+  EXPECT_EQ(1, value);
+  EXPECT_EQ(true, lru_replacer.Victim(value));
+  EXPECT_EQ(3, value);
+}
 TEST(LRUReplacerTest, PagePointerTest) { 
     LRUReplacer<Page*> lru_replacer;
-    Page* tmp = new Page();
+    FrameArena arena(1, PAGE_SIZE);
+    Page* tmp = arena.GetFrames();
     lru_replacer.Insert(tmp);
-    delete tmp;
 }
 } // namespace cmudb
@@ -0,0 +1,74 @@
+/**
+ * page_guard_test.cpp
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+
+namespace cmudb {
+
+TEST(PageGuardTest, SampleTest) {
+  DiskManager *disk_manager = new DiskManager("test.db");
+  {
+    BufferPoolManager bpm(4, disk_manager);
+
+    page_id_t page_id;
+    Page *page;
+    {
+      auto guard = bpm.NewPageGuarded(page_id);
+      ASSERT_EQ(true, static_cast<bool>(guard));
+      page = guard.GetPage();
+      EXPECT_EQ(1, page->GetPinCount());
+      strcpy(guard.GetData(), "Hello");
+      guard.SetDirty();
+
+      // moving hands the pin over, it is not released twice
+      PageGuard other(std::move(guard));
+      EXPECT_EQ(false, static_cast<bool>(guard));
+      EXPECT_EQ(1, page->GetPinCount());
+    }
+    EXPECT_EQ(0, page->GetPinCount());
+
+    // the latch goes away with the guard, a writer can take it afterwards
+    {
+      auto reader1 = bpm.FetchPageRead(page_id);
+      auto reader2 = bpm.FetchPageRead(page_id);
+      EXPECT_EQ(2, page->GetPinCount());
+      EXPECT_EQ(0, strcmp(reader1.GetData(), "Hello"));
+      reader1 = std::move(reader2);
+      EXPECT_EQ(1, page->GetPinCount());
+    }
+    {
+      auto writer = bpm.FetchPageWrite(page_id);
+      EXPECT_EQ(1, page->GetPinCount());
+      writer.Release();
+      EXPECT_EQ(0, page->GetPinCount());
+      EXPECT_EQ(false, static_cast<bool>(writer));
+    }
+
+    // all frames pinned, the guard is empty
+    std::vector<PageGuard> guards;
+    for (int i = 0; i < 4; ++i) {
+      page_id_t temp_page_id;
+      guards.push_back(bpm.NewPageGuarded(temp_page_id));
+    }
+    page_id_t temp_page_id;
+    EXPECT_EQ(false, static_cast<bool>(bpm.NewPageGuarded(temp_page_id)));
+    EXPECT_EQ(false, static_cast<bool>(bpm.FetchPageRead(page_id)));
+    guards.clear();
+
+    // the dirty page was written back when it was evicted
+    auto guard = bpm.FetchPageRead(page_id);
+    EXPECT_EQ(0, strcmp(guard.GetData(), "Hello"));
+  }
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+} // namespace cmudb
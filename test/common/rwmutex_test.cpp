@@ -2,7 +2,11 @@
  * rwmutex_test.cpp
  */
 
+#include <chrono>
+#include <cstdio>
+#include <mutex>
 #include <thread>
+#include <vector>
 
 #include "common/rwmutex.h"
 #include "gtest/gtest.h"
@@ -50,4 +54,76 @@ TEST(RWMutexTest, BasicTest) {
   }
   EXPECT_EQ(counter.Read(), 55);
 }
+
+// a reader must never see the two halves differ
+struct Pair {
+  uint64_t first = 0;
+  uint64_t second = 0;
+};
+
+// num_threads threads each take the lock ops times, every write_every-th
+// time exclusively. return ns per lock/unlock pair
+template <typename Lock, typename Unlock, typename RLock, typename RUnlock>
+double RunMix(int num_threads, int ops, int write_every, Pair &pair,
+              Lock lock, Unlock unlock, RLock rlock, RUnlock runlock) {
+  std::vector<std::thread> threads;
+  auto start = std::chrono::steady_clock::now();
+  for (int tid = 0; tid < num_threads; tid++) {
+    threads.push_back(std::thread([&, tid]() {
+      for (int i = 0; i < ops; i++) {
+        if (write_every != 0 && (i + tid) % write_every == 0) {
+          lock();
+          pair.first++;
+          pair.second++;
+          unlock();
+        } else {
+          rlock();
+          EXPECT_EQ(pair.first, pair.second);
+          runlock();
+        }
+      }
+    }));
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now() - start);
+  return static_cast<double>(elapsed.count()) / (num_threads * ops);
+}
+
+TEST(RWMutexTest, ContentionBenchmark) {
+  const int num_threads = 4;
+  const int ops = 100000;
+  // 0 means read only, 1 write only
+  const int write_every[] = {0, 100, 10, 2, 1};
+  for (int every : write_every) {
+    RWMutex rwmutex;
+    Pair pair;
+    double rw_ns = RunMix(num_threads, ops, every, pair,
+                          [&]() { rwmutex.WLock(); },
+                          [&]() { rwmutex.WUnlock(); },
+                          [&]() { rwmutex.RLock(); },
+                          [&]() { rwmutex.RUnlock(); });
+    int writes = 0;
+    for (int tid = 0; tid < num_threads; tid++) {
+      for (int i = 0; every != 0 && i < ops; i++) {
+        writes += (i + tid) % every == 0;
+      }
+    }
+    EXPECT_EQ(static_cast<uint64_t>(writes), pair.first);
+
+    // baseline, every access exclusive
+    std::mutex mutex;
+    Pair other;
+    double mutex_ns = RunMix(num_threads, ops, every, other,
+                             [&]() { mutex.lock(); },
+                             [&]() { mutex.unlock(); },
+                             [&]() { mutex.lock(); },
+                             [&]() { mutex.unlock(); });
+    printf("%d threads, %3d%% writes: RWMutex %.1f ns/op, std::mutex %.1f "
+           "ns/op\n",
+           num_threads, every == 0 ? 0 : 100 / every, rw_ns, mutex_ns);
+  }
 }
+} // namespace cmudb
@@ -0,0 +1,295 @@
+/**
+ * disk_manager_test.cpp
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <thread>
+#include <vector>
+
+#include "common/exception.h"
+#include "disk/disk_manager.h"
+#include "gtest/gtest.h"
+
+namespace cmudb {
+
+TEST(DiskManagerTest, PageSizeTest) {
+  char data[16384];
+  char buffer[16384];
+  {
+    DiskManager disk_manager("test.db", 16384);
+    EXPECT_EQ(16384, disk_manager.GetPageSize());
+    for (page_id_t page_id = 0; page_id < 3; ++page_id) {
+      memset(data, 'a' + page_id, sizeof(data));
+      disk_manager.WritePage(page_id, data);
+    }
+  }
+
+  // reopen, the page size comes from the superblock
+  {
+    DiskManager disk_manager("test.db", 4096);
+    EXPECT_EQ(16384, disk_manager.GetPageSize());
+    for (page_id_t page_id = 0; page_id < 3; ++page_id) {
+      memset(data, 'a' + page_id, sizeof(data));
+      disk_manager.ReadPage(page_id, buffer);
+      EXPECT_EQ(0, memcmp(data, buffer, sizeof(data)));
+    }
+  }
+  remove("test.db");
+  remove("test.log");
+
+  EXPECT_THROW(DiskManager("test.db", 512), Exception);
+  remove("test.db");
+  EXPECT_THROW(DiskManager("test.db", 12288), Exception);
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(DiskManagerTest, LegacyFileTest) {
+  // a file written before superblocks existed: 512 byte pages from offset 0
+  char data[LEGACY_PAGE_SIZE];
+  {
+    std::ofstream file("test.db", std::ios::binary);
+    for (int page_id = 0; page_id < 2; ++page_id) {
+      memset(data, 'x' + page_id, sizeof(data));
+      file.write(data, sizeof(data));
+    }
+  }
+
+  DiskManager disk_manager("test.db");
+  EXPECT_EQ(LEGACY_PAGE_SIZE, disk_manager.GetPageSize());
+  char buffer[LEGACY_PAGE_SIZE];
+  disk_manager.ReadPage(1, buffer);
+  memset(data, 'y', sizeof(data));
+  EXPECT_EQ(0, memcmp(data, buffer, sizeof(data)));
+  // no bitmaps, new pages go after the existing ones
+  EXPECT_EQ(2, disk_manager.AllocatePage());
+
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(DiskManagerTest, DirectIOTest) {
+  // direct I/O falls back to buffered I/O where the file system refuses it,
+  // the pages read back must be the same either way
+  for (bool direct_io : {false, true}) {
+    {
+      DiskManager disk_manager("test.db", PAGE_SIZE, direct_io);
+      if (!direct_io) {
+        EXPECT_EQ(false, disk_manager.IsDirectIO());
+      }
+
+      // threads write and read back their own pages without a shared
+      // cursor, through buffers that are not aligned
+      std::vector<std::thread> threads;
+      for (int tid = 0; tid < 4; ++tid) {
+        threads.emplace_back([&disk_manager, tid] {
+          std::vector<char> data(PAGE_SIZE + 1), buffer(PAGE_SIZE + 1);
+          for (page_id_t page_id = tid; page_id < 64; page_id += 4) {
+            memset(&data[1], 'a' + page_id % 26, PAGE_SIZE);
+            disk_manager.WritePage(page_id, &data[1]);
+            disk_manager.ReadPage(page_id, &buffer[1]);
+            EXPECT_EQ(0, memcmp(&data[1], &buffer[1], PAGE_SIZE));
+          }
+        });
+      }
+      for (auto &thread : threads) {
+        thread.join();
+      }
+      disk_manager.Sync();
+
+      // beyond the end of the file a page reads as zeros
+      char buffer[PAGE_SIZE];
+      disk_manager.ReadPage(100, buffer);
+      EXPECT_EQ(0, buffer[0]);
+      EXPECT_EQ(0, buffer[PAGE_SIZE - 1]);
+    }
+
+    DiskManager disk_manager("test.db");
+    char data[PAGE_SIZE];
+    char buffer[PAGE_SIZE];
+    for (page_id_t page_id = 0; page_id < 64; ++page_id) {
+      memset(data, 'a' + page_id % 26, sizeof(data));
+      disk_manager.ReadPage(page_id, buffer);
+      EXPECT_EQ(0, memcmp(data, buffer, sizeof(data)));
+    }
+    remove("test.db");
+    remove("test.log");
+  }
+}
+
+TEST(DiskManagerTest, AsyncIOTest) {
+  // the io_uring backend falls back to synchronous I/O where the kernel has
+  // no io_uring, the pages read back must be the same either way
+  for (IOBackend backend : {IOBackend::PREAD, IOBackend::IO_URING}) {
+    DiskManager disk_manager("test.db", PAGE_SIZE, false, backend);
+    if (backend == IOBackend::PREAD) {
+      EXPECT_EQ(IOBackend::PREAD, disk_manager.GetIOBackend());
+    }
+
+    // a batch of writes handed to the kernel at once
+    std::vector<std::vector<char>> pages(32, std::vector<char>(PAGE_SIZE));
+    std::vector<std::future<bool>> futures;
+    for (page_id_t page_id = 0; page_id < 32; ++page_id) {
+      memset(pages[page_id].data(), 'a' + page_id % 26, PAGE_SIZE);
+      futures.push_back(
+          disk_manager.WritePageAsync(page_id, pages[page_id].data(), false));
+    }
+    disk_manager.SubmitIO();
+    for (auto &future : futures) {
+      EXPECT_EQ(true, future.get());
+    }
+
+    // and read back, past the end of the file a page reads as zeros
+    std::vector<std::vector<char>> buffers(33, std::vector<char>(PAGE_SIZE, 1));
+    futures.clear();
+    for (page_id_t page_id = 0; page_id < 33; ++page_id) {
+      futures.push_back(
+          disk_manager.ReadPageAsync(page_id, buffers[page_id].data()));
+    }
+    for (page_id_t page_id = 0; page_id < 33; ++page_id) {
+      EXPECT_EQ(true, futures[page_id].get());
+      if (page_id < 32) {
+        EXPECT_EQ(0, memcmp(pages[page_id].data(), buffers[page_id].data(),
+                            PAGE_SIZE));
+      } else {
+        EXPECT_EQ(0, buffers[page_id][0]);
+      }
+    }
+
+    // log appends in flight together land in order
+    char log_data[] = "0123456789";
+    futures.clear();
+    for (int i = 0; i < 10; ++i) {
+      futures.push_back(disk_manager.WriteLogAsync(log_data + i, 1, i == 9));
+    }
+    for (auto &future : futures) {
+      EXPECT_EQ(true, future.get());
+    }
+    char buffer[11] = {};
+    EXPECT_EQ(true, disk_manager.ReadLog(buffer, 10, 0));
+    EXPECT_EQ(0, strcmp(log_data, buffer));
+
+    remove("test.db");
+    remove("test.log");
+  }
+}
+
+TEST(DiskManagerTest, VectoredIOTest) {
+  for (bool direct_io : {false, true}) {
+    DiskManager disk_manager("test.db", PAGE_SIZE, direct_io);
+
+    // two runs with a hole in between, one of them through unaligned buffers
+    std::vector<char> data(10 * PAGE_SIZE + 1);
+    std::vector<const char *> pages;
+    for (int i = 0; i < 10; ++i) {
+      memset(&data[1 + i * PAGE_SIZE], 'a' + i, PAGE_SIZE);
+      pages.push_back(&data[1 + i * PAGE_SIZE]);
+    }
+    disk_manager.WritePages(0, pages.data(), 4);
+    disk_manager.WritePages(6, pages.data() + 6, 4);
+    disk_manager.Sync();
+
+    // one read over both runs, the hole and past the end of the file
+    std::vector<std::vector<char>> buffers(12, std::vector<char>(PAGE_SIZE, 1));
+    std::vector<char *> reads;
+    for (auto &buffer : buffers) {
+      reads.push_back(buffer.data());
+    }
+    disk_manager.ReadPages(0, reads.data(), reads.size());
+    for (int i = 0; i < 12; ++i) {
+      if (i < 4 || (i >= 6 && i < 10)) {
+        EXPECT_EQ(0, memcmp(pages[i], reads[i], PAGE_SIZE));
+      } else {
+        EXPECT_EQ(0, reads[i][0]);
+        EXPECT_EQ(0, reads[i][PAGE_SIZE - 1]);
+      }
+    }
+
+    remove("test.db");
+    remove("test.log");
+  }
+}
+
+TEST(DiskManagerTest, AllocatorTest) {
+  char data[PAGE_SIZE];
+  char buffer[PAGE_SIZE];
+  {
+    DiskManager disk_manager("test.db");
+    for (page_id_t page_id = 0; page_id < 100; ++page_id) {
+      EXPECT_EQ(page_id, disk_manager.AllocatePage());
+      memset(data, 'a' + page_id % 26, sizeof(data));
+      disk_manager.WritePage(page_id, data);
+    }
+    disk_manager.DeallocatePage(10);
+    disk_manager.DeallocatePage(50);
+  }
+
+  // reopen, the allocation state comes from the bitmaps in the file
+  {
+    DiskManager disk_manager("test.db");
+    EXPECT_EQ(100, disk_manager.GetNextPageId());
+    for (page_id_t page_id = 0; page_id < 100; ++page_id) {
+      memset(data, 'a' + page_id % 26, sizeof(data));
+      disk_manager.ReadPage(page_id, buffer);
+      EXPECT_EQ(0, memcmp(data, buffer, sizeof(data)));
+    }
+    EXPECT_EQ(10, disk_manager.AllocatePage());
+    EXPECT_EQ(50, disk_manager.AllocatePage());
+    EXPECT_EQ(100, disk_manager.AllocatePage());
+    disk_manager.WritePage(100, data);
+    disk_manager.Sync();
+
+    // delete heavy churn reuses the freed pages, the file does not grow
+    long long file_size;
+    {
+      std::ifstream file("test.db", std::ios::binary | std::ios::ate);
+      file_size = file.tellg();
+    }
+    for (int round = 0; round < 20; ++round) {
+      std::vector<page_id_t> page_ids;
+      for (int i = 0; i < 30; ++i) {
+        page_id_t page_id = disk_manager.AllocatePage();
+        disk_manager.WritePage(page_id, data);
+        page_ids.push_back(page_id);
+      }
+      for (page_id_t page_id : page_ids) {
+        disk_manager.DeallocatePage(page_id);
+      }
+    }
+    disk_manager.Sync();
+    EXPECT_GE(131, disk_manager.GetNextPageId());
+    std::ifstream file("test.db", std::ios::binary | std::ios::ate);
+    EXPECT_GE(file_size + 30 * PAGE_SIZE, file.tellg());
+  }
+  remove("test.db");
+
+  // a run of pages across the bitmap page of the next group
+  {
+    DiskManager disk_manager("test.db");
+    page_id_t first = PAGE_SIZE * 8 - 2;
+    std::vector<std::vector<char>> pages(4, std::vector<char>(PAGE_SIZE));
+    std::vector<const char *> writes;
+    std::vector<char *> reads;
+    for (int i = 0; i < 4; ++i) {
+      memset(pages[i].data(), 'a' + i, PAGE_SIZE);
+      writes.push_back(pages[i].data());
+    }
+    disk_manager.WritePages(first, writes.data(), writes.size());
+    std::vector<std::vector<char>> buffers(4, std::vector<char>(PAGE_SIZE));
+    for (auto &page : buffers) {
+      reads.push_back(page.data());
+    }
+    disk_manager.ReadPages(first, reads.data(), reads.size());
+    for (int i = 0; i < 4; ++i) {
+      EXPECT_EQ(0, memcmp(writes[i], reads[i], PAGE_SIZE));
+      disk_manager.ReadPage(first + i, buffer);
+      EXPECT_EQ(0, memcmp(writes[i], buffer, PAGE_SIZE));
+    }
+  }
+  remove("test.db");
+  remove("test.log");
+}
+
+} // namespace cmudb
@@ -0,0 +1,118 @@
+/**
+ * page_allocator_test.cpp
+ */
+
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "disk/page_allocator.h"
+#include "gtest/gtest.h"
+
+namespace cmudb {
+
+TEST(PageAllocatorTest, SampleTest) {
+  // 64 byte bitmaps, 512 pages per group
+  PageAllocator allocator(64);
+  EXPECT_EQ(512, allocator.GetPagesPerGroup());
+  EXPECT_EQ(0, allocator.GetNumGroups());
+
+  // the first allocation adds a group
+  for (page_id_t page_id = 0; page_id < 20; ++page_id) {
+    EXPECT_EQ(page_id, allocator.Allocate());
+  }
+  EXPECT_EQ(1, allocator.GetNumGroups());
+  EXPECT_EQ(20, allocator.GetNextPageId());
+
+  // the lowest free page is reused first
+  EXPECT_EQ(true, allocator.Deallocate(7));
+  EXPECT_EQ(true, allocator.Deallocate(3));
+  EXPECT_EQ(false, allocator.Deallocate(3));
+  EXPECT_EQ(false, allocator.IsAllocated(3));
+  EXPECT_EQ(3, allocator.Allocate());
+  EXPECT_EQ(7, allocator.Allocate());
+  EXPECT_EQ(20, allocator.Allocate());
+
+  // near a page: the rest of its extent, then a free extent
+  EXPECT_EQ(21, allocator.Allocate(20));
+  EXPECT_EQ(22, allocator.Allocate(20));
+  EXPECT_EQ(23, allocator.Allocate(21));
+  EXPECT_EQ(24, allocator.Allocate(23));
+  allocator.Allocate();
+  // page 25 is taken by another structure, the rest of the extent is not
+  EXPECT_EQ(26, allocator.Allocate(24));
+  EXPECT_EQ(27, allocator.Allocate(31));
+
+  // a full group makes room in a new one
+  std::set<page_id_t> page_ids;
+  while (allocator.GetNextPageId() < 512) {
+    page_ids.insert(allocator.Allocate());
+  }
+  EXPECT_EQ(1, allocator.GetNumGroups());
+  EXPECT_EQ(512, allocator.Allocate());
+  EXPECT_EQ(2, allocator.GetNumGroups());
+  EXPECT_EQ(513, allocator.GetNextPageId());
+
+  // no free extent left: near a page takes the lowest free page rather
+  // than growing the file
+  while (allocator.GetNextPageId() < 1024) {
+    allocator.Allocate();
+  }
+  EXPECT_EQ(true, allocator.Deallocate(100));
+  EXPECT_EQ(true, allocator.Deallocate(700));
+  EXPECT_EQ(100, allocator.Allocate(5));
+  EXPECT_EQ(700, allocator.Allocate(5));
+  EXPECT_EQ(2, allocator.GetNumGroups());
+}
+
+TEST(PageAllocatorTest, PersistTest) {
+  std::vector<std::pair<size_t, std::vector<char>>> groups;
+  {
+    PageAllocator allocator(64);
+    for (int i = 0; i < 600; ++i) {
+      allocator.Allocate();
+    }
+    allocator.Deallocate(5);
+    allocator.Deallocate(599);
+    EXPECT_EQ(true, allocator.IsDirty());
+    allocator.TakeDirtyGroups(groups);
+    EXPECT_EQ(false, allocator.IsDirty());
+    EXPECT_EQ(2, groups.size());
+
+    // only the group that changed is handed out again
+    std::vector<std::pair<size_t, std::vector<char>>> changed;
+    allocator.Deallocate(3);
+    allocator.TakeDirtyGroups(changed);
+    ASSERT_EQ(1, changed.size());
+    EXPECT_EQ(0, changed[0].first);
+    groups[0] = changed[0];
+
+    // a bitmap that could not be written is handed out again
+    changed.clear();
+    allocator.MarkDirty(1);
+    EXPECT_EQ(true, allocator.IsDirty());
+    allocator.TakeDirtyGroups(changed);
+    ASSERT_EQ(1, changed.size());
+    EXPECT_EQ(1, changed[0].first);
+  }
+
+  // bitmaps read back from disk
+  PageAllocator allocator(64);
+  for (auto &group : groups) {
+    allocator.AddGroup(group.second.data());
+  }
+  EXPECT_EQ(false, allocator.IsDirty());
+  EXPECT_EQ(599, allocator.GetNextPageId());
+  EXPECT_EQ(false, allocator.IsAllocated(3));
+  EXPECT_EQ(true, allocator.IsAllocated(4));
+  EXPECT_EQ(3, allocator.Allocate());
+  EXPECT_EQ(5, allocator.Allocate());
+  EXPECT_EQ(599, allocator.Allocate());
+
+  // an empty group is written out on the next call
+  allocator.AddGroup(nullptr);
+  EXPECT_EQ(true, allocator.IsDirty());
+  EXPECT_EQ(3, allocator.GetNumGroups());
+}
+
+} // namespace cmudb
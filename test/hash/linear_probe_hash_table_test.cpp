@@ -0,0 +1,103 @@
+/**
+ * linear_probe_hash_table_test.cpp
+ */
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "hash/linear_probe_hash_table.h"
+#include "gtest/gtest.h"
+
+namespace cmudb {
+
+TEST(LinearProbeHashTableTest, SampleTest) {
+  LinearProbeHashTable<int, int> table(8);
+  EXPECT_EQ(16, table.GetNumSlots());
+
+  for (int i = 0; i < 8; ++i) {
+    table.Insert(i, i * 10);
+  }
+  EXPECT_EQ(8, table.Size());
+
+  int value;
+  for (int i = 0; i < 8; ++i) {
+    EXPECT_EQ(true, table.Find(i, value));
+    EXPECT_EQ(i * 10, value);
+  }
+  EXPECT_EQ(false, table.Find(8, value));
+
+  // override
+  table.Insert(3, 33);
+  EXPECT_EQ(true, table.Find(3, value));
+  EXPECT_EQ(33, value);
+  EXPECT_EQ(8, table.Size());
+
+  // remove
+  EXPECT_EQ(true, table.Remove(3));
+  EXPECT_EQ(false, table.Remove(3));
+  EXPECT_EQ(false, table.Find(3, value));
+  EXPECT_EQ(7, table.Size());
+}
+
+TEST(LinearProbeHashTableTest, ChurnTest) {
+  // keep the table at capacity while keys keep changing, tombstones must not
+  // exhaust the free slots
+  const int capacity = 10;
+  LinearProbeHashTable<int, int> table(capacity);
+  for (int i = 0; i < capacity; ++i) {
+    table.Insert(i, i);
+  }
+  for (int i = capacity; i < 10000; ++i) {
+    EXPECT_EQ(true, table.Remove(i - capacity));
+    table.Insert(i, i);
+  }
+  EXPECT_EQ(capacity, table.Size());
+  int value;
+  for (int i = 10000 - capacity; i < 10000; ++i) {
+    EXPECT_EQ(true, table.Find(i, value));
+    EXPECT_EQ(i, value);
+  }
+}
+
+TEST(LinearProbeHashTableTest, ConcurrentFindTest) {
+  // readers never see a value that was not stored under their key
+  LinearProbeHashTable<int, int> table(64);
+  for (int i = 0; i < 32; ++i) {
+    table.Insert(i, i);
+  }
+  std::atomic<bool> stop(false);
+  std::thread writer([&table, &stop]() {
+    for (int round = 0; round < 20000; ++round) {
+      int key = 32 + round % 32;
+      table.Insert(key, key);
+      table.Remove(key);
+    }
+    stop = true;
+  });
+
+  std::vector<std::thread> readers;
+  for (int tid = 0; tid < 4; ++tid) {
+    readers.push_back(std::thread([&table, &stop]() {
+      int value;
+      while (!stop) {
+        for (int key = 0; key < 64; ++key) {
+          bool found = table.Find(key, value);
+          if (key < 32) {
+            EXPECT_EQ(true, found);
+          }
+          if (found) {
+            EXPECT_EQ(key, value);
+          }
+        }
+      }
+    }));
+  }
+  writer.join();
+  for (auto &reader : readers) {
+    reader.join();
+  }
+  EXPECT_EQ(32, table.Size());
+}
+
+} // namespace cmudb
@@ -3,6 +3,7 @@
  */
 
 #include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <cstdio>
 #include <functional>
@@ -151,8 +152,8 @@ TEST(BPlusTreeConcurrentTest, InsertTest1) {
 
   bpm->UnpinPage(HEADER_PAGE_ID, true);
 
-  delete disk_manager;
   delete bpm;
+  delete disk_manager;
   remove("test.db");
   remove("test.log");
 }
@@ -205,8 +206,8 @@ TEST(BPlusTreeConcurrentTest, InsertTest2) {
 
   bpm->UnpinPage(HEADER_PAGE_ID, true);
 
-  delete disk_manager;
   delete bpm;
+  delete disk_manager;
   remove("test.db");
   remove("test.log");
 }
@@ -251,8 +252,8 @@ TEST(BPlusTreeConcurrentTest, DeleteTest1) {
 
   bpm->UnpinPage(HEADER_PAGE_ID, true);
 
-  delete disk_manager;
   delete bpm;
+  delete disk_manager;
   remove("test.db");
   remove("test.log");
 }
@@ -297,8 +298,8 @@ TEST(BPlusTreeConcurrentTest, DeleteTest2) {
   EXPECT_EQ(size, 4);
 
   bpm->UnpinPage(HEADER_PAGE_ID, true);
-  delete disk_manager;
   delete bpm;
+  delete disk_manager;
   remove("test.db");
   remove("test.log");
 }
@@ -344,8 +345,8 @@ TEST(BPlusTreeConcurrentTest, MixTest) {
   EXPECT_EQ(size, 5);
 
   bpm->UnpinPage(HEADER_PAGE_ID, true);
-  delete disk_manager;
   delete bpm;
+  delete disk_manager;
   remove("test.db");
   remove("test.log");
 }
@@ -410,8 +411,61 @@ TEST(BPlusTreeConcurrentTest, MixTest2) {
   EXPECT_EQ(size, 100);
 
   bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
   delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeConcurrentTest, ReadWriteTest) {
+  // create KeyComparator and index schema
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  // create b+ tree
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm,
+                                                           comparator);
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(page_id);
+  (void) header_page;
+
+  // even keys stay in the tree, odd keys come and go while readers look up
+  // the even ones, splits and merges must never make them disappear
+  std::vector<int64_t> stable_keys, moving_keys;
+  for (int64_t key = 1; key <= 4000; ++key) {
+    (key % 2 == 0 ? stable_keys : moving_keys).push_back(key);
+  }
+  InsertHelper(tree, stable_keys);
+
+  std::atomic<bool> stop(false);
+  std::thread writer([&tree, &moving_keys, &stop] {
+    for (int round = 0; round < 3; ++round) {
+      InsertHelper(tree, moving_keys);
+      DeleteHelper(tree, moving_keys);
+    }
+    stop = true;
+  });
+  LaunchParallelTest(4, [&tree, &stable_keys, &stop](uint64_t) {
+    GenericKey<8> index_key;
+    std::vector<RID> rids;
+    while (!stop) {
+      for (auto key : stable_keys) {
+        rids.clear();
+        index_key.SetFromInteger(key);
+        EXPECT_EQ(true, tree.GetValue(index_key, rids));
+        ASSERT_EQ(1, rids.size());
+        EXPECT_EQ(key, rids[0].GetSlotNum());
+      }
+    }
+  });
+  writer.join();
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
   delete bpm;
+  delete disk_manager;
   remove("test.db");
   remove("test.log");
 }
@@ -3,6 +3,7 @@
  */
 
 #include <algorithm>
+#include <chrono>
 #include <cstdio>
 #include <iostream>
 #include <sstream>
@@ -10,6 +11,7 @@
 #include "buffer/buffer_pool_manager.h"
 #include "common/logger.h"
 #include "index/b_plus_tree.h"
+#include "page/header_page.h"
 #include "vtable/virtual_table.h"
 #include "gtest/gtest.h"
 
@@ -69,8 +71,8 @@ TEST(BPlusTreeTests, InsertTest1) {
 
   bpm->UnpinPage(HEADER_PAGE_ID, true);
   delete transaction;
-  delete disk_manager;
   delete bpm;
+  delete disk_manager;
   remove("test.db");
   remove("test.log");
 }
@@ -142,8 +144,8 @@ TEST(BPlusTreeTests, InsertTest2) {
 
   bpm->UnpinPage(HEADER_PAGE_ID, true);
   delete transaction;
-  delete disk_manager;
   delete bpm;
+  delete disk_manager;
   remove("test.db");
   remove("test.log");
 }
@@ -209,8 +211,8 @@ TEST(BPlusTreeTests, InsertScale) {
 
   bpm->UnpinPage(HEADER_PAGE_ID, true);
   delete transaction;
-  delete disk_manager;
   delete bpm;
+  delete disk_manager;
   remove("test.db");
   remove("test.log");
 }
@@ -281,8 +283,8 @@ TEST(BPlusTreeTests, InsertRandom) {
 
   bpm->UnpinPage(HEADER_PAGE_ID, true);
   delete transaction;
-  delete disk_manager;
   delete bpm;
+  delete disk_manager;
   remove("test.db");
   remove("test.log");
 }
@@ -357,8 +359,8 @@ TEST(BPlusTreeTests, DeleteBasic) {
 
   bpm->UnpinPage(HEADER_PAGE_ID, true);
   delete transaction;
-  delete disk_manager;
   delete bpm;
+  delete disk_manager;
   remove("test.db");
   remove("test.log");
 }
@@ -439,8 +441,8 @@ TEST(BPlusTreeTests, DeleteScale) {
 
   bpm->UnpinPage(HEADER_PAGE_ID, true);
   delete transaction;
-  delete disk_manager;
   delete bpm;
+  delete disk_manager;
   remove("test.db");
   remove("test.log");
 }
@@ -504,8 +506,8 @@ TEST(BPlusTreeTests, DeleteRandom) {
 
   bpm->UnpinPage(HEADER_PAGE_ID, true);
   delete transaction;
-  delete disk_manager;
   delete bpm;
+  delete disk_manager;
   remove("test.db");
   remove("test.log");
 }
@@ -586,8 +588,8 @@ TEST(BPlusTreeTests, DeleteTest1) {
 
   bpm->UnpinPage(HEADER_PAGE_ID, true);
   delete transaction;
-  delete disk_manager;
   delete bpm;
+  delete disk_manager;
   remove("test.db");
   remove("test.log");
 }
@@ -667,8 +669,8 @@ TEST(BPlusTreeTests, DeleteTest2) {
 
   bpm->UnpinPage(HEADER_PAGE_ID, true);
   delete transaction;
-  delete disk_manager;
   delete bpm;
+  delete disk_manager;
   remove("test.db");
   remove("test.log");
 }
@@ -749,12 +751,81 @@ TEST(BPlusTreeTests, ScaleTest) {
 
   bpm->UnpinPage(HEADER_PAGE_ID, true);
   delete transaction;
-  delete disk_manager;
   delete bpm;
+  delete disk_manager;
   remove("test.db");
   remove("test.log");
 }
 
+TEST(BPlusTreeTests, PageSizeTest) {
+  // fan-out and scan time for every supported page size, the pool is too
+  // small to hold the tree so the scan has to go to disk
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  const int64_t scale = 20000;
+  int last_leaf_max_size = 0;
+
+  for (size_t page_size = MIN_PAGE_SIZE; page_size <= MAX_PAGE_SIZE;
+       page_size *= 2) {
+    DiskManager *disk_manager = new DiskManager("test.db", page_size);
+    BufferPoolManager *bpm = new BufferPoolManager(8, disk_manager);
+    BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm,
+                                                             comparator);
+    GenericKey<8> index_key;
+    RID rid;
+    Transaction *transaction = new Transaction(0);
+    page_id_t page_id;
+    auto header_page = static_cast<HeaderPage *>(bpm->NewPage(page_id));
+    header_page->Init();
+
+    for (int64_t key = 0; key < scale; ++key) {
+      rid.Set(0, key);
+      index_key.SetFromInteger(key);
+      tree.Insert(index_key, rid, transaction);
+    }
+
+    // leaf fan-out
+    page_id_t root_page_id;
+    EXPECT_EQ(true, header_page->GetRootId("foo_pk", root_page_id));
+    auto root = reinterpret_cast<
+        BPlusTreeInternalPage<GenericKey<8>, page_id_t, GenericComparator<8>>
+            *>(bpm->FetchPage(root_page_id)->GetData());
+    ASSERT_EQ(false, root->IsLeafPage());
+    page_id_t leaf_page_id = root->ValueAt(0);
+    int internal_max_size = root->GetMaxSize();
+    bpm->UnpinPage(root_page_id, false);
+    auto leaf = reinterpret_cast<BPlusTreePage *>(
+        bpm->FetchPage(leaf_page_id)->GetData());
+    int leaf_max_size = leaf->GetMaxSize();
+    bpm->UnpinPage(leaf_page_id, false);
+    EXPECT_GT(leaf_max_size, last_leaf_max_size);
+    last_leaf_max_size = leaf_max_size;
+
+    auto start = std::chrono::steady_clock::now();
+    int64_t size = 0;
+    index_key.SetFromInteger(0);
+    for (auto iterator = tree.Begin(index_key); iterator.isEnd() == false;
+         ++iterator) {
+      EXPECT_EQ(size, (*iterator).second.GetSlotNum());
+      ++size;
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start);
+    EXPECT_EQ(scale, size);
+    printf("page size %6zu: leaf fan-out %4d, internal fan-out %4d, "
+           "scan %lld us\n",
+           page_size, leaf_max_size, internal_max_size,
+           static_cast<long long>(elapsed.count()));
+
+    bpm->UnpinPage(HEADER_PAGE_ID, true);
+    delete transaction;
+    delete bpm;
+    delete disk_manager;
+    remove("test.db");
+    remove("test.log");
+  }
+}
+
 TEST(BPlusTreeTests, RandomTest) {
   // create KeyComparator and index schema
   Schema *key_schema = ParseCreateStatement("a bigint");
@@ -834,8 +905,8 @@ TEST(BPlusTreeTests, RandomTest) {
 
   bpm->UnpinPage(HEADER_PAGE_ID, true);
   delete transaction;
-  delete disk_manager;
   delete bpm;
+  delete disk_manager;
   remove("test.db");
   remove("test.log");
 }
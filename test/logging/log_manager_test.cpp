@@ -124,4 +124,44 @@ TEST(LogManagerTest, RedoTestWithOneTxn) {
   remove("test.log");
 }
 
+TEST(LogManagerTest, FlushThreadTest) {
+  DiskManager *disk_manager = new DiskManager("test.db");
+  LogManager *log_manager = new LogManager(disk_manager);
+  log_manager->RunFlushThread();
+  EXPECT_TRUE(ENABLE_LOGGING);
+
+  // a waiter gets its records flushed without waiting for the timeout
+  LogRecord begin(0, INVALID_LSN, LogRecordType::BEGIN);
+  lsn_t lsn = log_manager->AppendLogRecord(begin);
+  EXPECT_EQ(0, lsn);
+  auto start = std::chrono::steady_clock::now();
+  log_manager->WaitUntilPersistent(lsn);
+  EXPECT_LT(std::chrono::steady_clock::now() - start, LOG_TIMEOUT);
+  EXPECT_LE(lsn, log_manager->GetPersistentLSN());
+
+  // appends keep going when the log buffer fills up
+  const int header_size = begin.GetSize();
+  int count = LOG_BUFFER_SIZE / header_size * 3;
+  for (int i = 1; i <= count; ++i) {
+    LogRecord commit(i, INVALID_LSN, LogRecordType::COMMIT);
+    EXPECT_EQ(i, log_manager->AppendLogRecord(commit));
+  }
+  log_manager->StopFlushThread();
+  EXPECT_FALSE(ENABLE_LOGGING);
+  EXPECT_EQ(count, log_manager->GetPersistentLSN());
+
+  // every record is in the log file, header first
+  char header[20];
+  for (int i = 0; i <= count; i += count / 4) {
+    ASSERT_TRUE(disk_manager->ReadLog(header, header_size, i * header_size));
+    EXPECT_EQ(header_size, *reinterpret_cast<int32_t *>(header));
+    EXPECT_EQ(i, *reinterpret_cast<lsn_t *>(header + 4));
+  }
+
+  delete log_manager;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
 } // namespace cmudb
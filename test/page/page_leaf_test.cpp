@@ -29,7 +29,7 @@ TEST(LeafNodeTests, InsertTest1) {
     page_id_t leaf_page_id;
     Page* leaf_page = bpm->NewPage(leaf_page_id);
     BPlusTreeLeafPage<GenericKey<4>,RID,GenericComparator<4>>* leaf = new BPlusTreeLeafPage<GenericKey<4>, RID, GenericComparator<4>>(); 
-    leaf->Init(leaf_page_id);
+    leaf->Init(leaf_page_id, bpm->GetPageSize());
     /* start test */
     int counter = 0;
     for (auto key: keys) {
@@ -42,8 +42,8 @@ TEST(LeafNodeTests, InsertTest1) {
     }
     delete leaf;
     //delete tnx;
-    delete disk_manager;
     delete bpm;
+    delete disk_manager;
     remove("test.db");
     remove("test.log");
 }
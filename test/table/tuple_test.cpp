@@ -47,12 +47,44 @@ TEST(TupleTest, TableHeapTest) {
     ++itr;
   }
 
+  // the same scan through a ring of frames sees every tuple as well
+  int count = 0;
+  {
+    TableIterator ring_itr =
+        table->begin(transaction, buffer_pool_manager->GetAccessStrategy());
+    for (; ring_itr != table->end(); ++ring_itr) {
+      ++count;
+    }
+  }
+  EXPECT_EQ(5000, count);
+  EXPECT_LT(0, buffer_pool_manager->GetStats().ring_reuses);
+
   // int i = 0;
   std::random_shuffle(rid_v.begin(), rid_v.end());
   for (auto rid : rid_v) {
     // std::cout << i++ << std::endl;
     assert(table->MarkDelete(rid, transaction) == 1);
   }
+
+  // dropping the table gives its pages back, new pages reuse them
+  page_id_t first_page_id = table->GetFirstPageId();
+  page_id_t next_page_id = disk_manager->GetNextPageId();
+  // a pinned page stops the drop, the heap then starts at that page
+  page_id_t second_page_id =
+      static_cast<TablePage *>(buffer_pool_manager->FetchPage(first_page_id))
+          ->GetNextPageId();
+  buffer_pool_manager->UnpinPage(first_page_id, false);
+  ASSERT_NE(nullptr, buffer_pool_manager->FetchPage(second_page_id));
+  EXPECT_EQ(false, table->DeleteTableHeap());
+  EXPECT_EQ(second_page_id, table->GetFirstPageId());
+  buffer_pool_manager->UnpinPage(second_page_id, false);
+  EXPECT_EQ(true, table->DeleteTableHeap());
+  EXPECT_EQ(INVALID_PAGE_ID, table->GetFirstPageId());
+  page_id_t page_id;
+  EXPECT_NE(nullptr, buffer_pool_manager->NewPage(page_id));
+  EXPECT_EQ(first_page_id, page_id);
+  buffer_pool_manager->UnpinPage(page_id, false);
+  EXPECT_EQ(next_page_id, disk_manager->GetNextPageId());
   remove("test.db"); // remove db file
   remove("test.log");
   delete schema;